@@ -108,11 +108,16 @@ CargoPacket *CargoPacket::Split(uint new_size)
 }
 
 /**
- * Merge another packet into this one.
+ * Merge another packet into this one. If the packets differ in age the
+ * resulting age is the average of both, weighted by the amount of cargo.
  * @param cp Packet to be merged in.
  */
 void CargoPacket::Merge(CargoPacket *cp)
 {
+	if (this->periods_in_transit != cp->periods_in_transit) {
+		uint64_t periods = static_cast<uint64_t>(this->periods_in_transit) * this->count + static_cast<uint64_t>(cp->periods_in_transit) * cp->count;
+		this->periods_in_transit = static_cast<uint16_t>(periods / (this->count + cp->count));
+	}
 	this->count += cp->count;
 	this->feeder_share += cp->feeder_share;
 	delete cp;
@@ -262,6 +267,7 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 	assert(cp != nullptr);
 	assert(action == MTA_LOAD ||
 			(action == MTA_KEEP && this->action_counts[MTA_LOAD] == 0));
+	this->ApplyAging();
 	this->AddToMeta(cp, action);
 
 	if (this->count == cp->count) {
@@ -294,6 +300,7 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 template <class Taction>
 void VehicleCargoList::ShiftCargo(Taction action)
 {
+	this->ApplyAging();
 	Iterator it(this->packets.begin());
 	while (it != this->packets.end() && action.MaxMove() > 0) {
 		CargoPacket *cp = *it;
@@ -317,6 +324,7 @@ template <class Taction>
 void VehicleCargoList::PopCargo(Taction action)
 {
 	if (this->packets.empty()) return;
+	this->ApplyAging();
 	Iterator it(--(this->packets.end()));
 	Iterator begin(this->packets.begin());
 	while (action.MaxMove() > 0) {
@@ -379,24 +387,57 @@ void VehicleCargoList::RemoveFromMeta(const CargoPacket *cp, MoveToAction action
  */
 void VehicleCargoList::AddToMeta(const CargoPacket *cp, MoveToAction action)
 {
+	assert(this->unapplied_periods == 0);
 	this->AssertCountConsistency();
 	this->AddToCache(cp);
 	this->action_counts[action] += cp->count;
+	this->max_periods_in_transit = std::max(this->max_periods_in_transit, cp->periods_in_transit);
 	this->AssertCountConsistency();
 }
 
 /**
- * Ages the all cargo in this list.
+ * Ages the all cargo in this list. As long as no packet can reach the maximum
+ * age, only the cache is updated and the aging of the packets themselves is
+ * deferred until they are accessed next, see ApplyAging().
  */
 void VehicleCargoList::AgeCargo()
 {
+	if (this->packets.empty()) return;
+
+	if (this->max_periods_in_transit + this->unapplied_periods < UINT16_MAX) {
+		this->unapplied_periods++;
+		this->cargo_periods_in_transit += this->count;
+		return;
+	}
+
+	this->ApplyAging();
+	uint16_t max_periods = 0;
 	for (const auto &cp : this->packets) {
 		/* If we're at the maximum, then we can't increase no more. */
-		if (cp->periods_in_transit == UINT16_MAX) continue;
+		if (cp->periods_in_transit != UINT16_MAX) {
+			cp->periods_in_transit++;
+			this->cargo_periods_in_transit += cp->count;
+		}
+		max_periods = std::max(max_periods, cp->periods_in_transit);
+	}
+	this->max_periods_in_transit = max_periods;
+}
+
+/**
+ * Adds the aging deferred by AgeCargo() to the packets in this list. This has
+ * to happen before any packet enters or leaves the list, or its age is used.
+ */
+void VehicleCargoList::ApplyAging()
+{
+	if (this->unapplied_periods == 0) return;
 
-		cp->periods_in_transit++;
-		this->cargo_periods_in_transit += cp->count;
+	uint16_t max_periods = 0;
+	for (const auto &cp : this->packets) {
+		cp->periods_in_transit += this->unapplied_periods;
+		max_periods = std::max(max_periods, cp->periods_in_transit);
 	}
+	this->max_periods_in_transit = max_periods;
+	this->unapplied_periods = 0;
 }
 
 /**
@@ -441,6 +482,7 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 {
 	this->AssertCountConsistency();
 	assert(this->action_counts[MTA_LOAD] == 0);
+	this->ApplyAging();
 	this->action_counts[MTA_TRANSFER] = this->action_counts[MTA_DELIVER] = this->action_counts[MTA_KEEP] = 0;
 	Iterator deliver = this->packets.end();
 	Iterator it = this->packets.begin();
@@ -534,6 +576,7 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 /** Invalidates the cached data and rebuild it. */
 void VehicleCargoList::InvalidateCache()
 {
+	this->ApplyAging();
 	this->feeder_share = 0;
 	this->Parent::InvalidateCache();
 }
@@ -668,6 +711,7 @@ uint VehicleCargoList::Truncate(uint max_move)
 uint VehicleCargoList::Reroute(uint max_move, VehicleCargoList *dest, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
 	max_move = std::min(this->action_counts[MTA_TRANSFER], max_move);
+	dest->ApplyAging();
 	this->ShiftCargo(VehicleCargoReroute(this, dest, max_move, avoid, avoid2, ge));
 	return max_move;
 }
@@ -691,16 +735,74 @@ void StationCargoList::Append(CargoPacket *cp, StationID next)
 	assert(cp != nullptr);
 	this->AddToCache(cp);
 
+	uint16_t age_tolerance = _settings_game.station.cargo_merge_age_tolerance;
 	StationCargoPacketMap::List &list = this->packets[next];
 	for (StationCargoPacketMap::List::reverse_iterator it(list.rbegin());
 			it != list.rend(); it++) {
-		if (StationCargoList::TryMerge(*it, cp)) return;
+		if (this->TryMergeAged(*it, cp, age_tolerance)) return;
 	}
 
 	/* The packet could not be merged with another one */
 	list.push_back(cp);
 }
 
+/**
+ * Tries to merge the second packet into the first, allowing the packets to
+ * differ in age. Both packets have to be in the cache already.
+ * @param icp Packet to be merged into.
+ * @param cp Packet to be eliminated.
+ * @param age_tolerance Maximum difference in cargo aging periods.
+ * @return If the packets could be merged.
+ */
+bool StationCargoList::TryMergeAged(CargoPacket *icp, CargoPacket *cp, uint16_t age_tolerance)
+{
+	if (!StationCargoList::AreMergable(icp, cp, age_tolerance) ||
+			icp->count + cp->count > CargoPacket::MAX_COUNT) {
+		return false;
+	}
+
+	/* Averaging the age rounds down, so the cached periods have to follow. */
+	this->cargo_periods_in_transit -= static_cast<uint64_t>(icp->periods_in_transit) * icp->count +
+			static_cast<uint64_t>(cp->periods_in_transit) * cp->count;
+	icp->Merge(cp);
+	this->cargo_periods_in_transit += static_cast<uint64_t>(icp->periods_in_transit) * icp->count;
+	return true;
+}
+
+/**
+ * Merges packets waiting for the same next hop which only differ in age by
+ * at most the given tolerance. Packets are merged into the earliest fitting
+ * packet in the list, so the order of the remaining packets is preserved.
+ * @param age_tolerance Maximum difference in cargo aging periods.
+ * @return Number of packets eliminated.
+ */
+uint StationCargoList::Compact(uint16_t age_tolerance)
+{
+	using SourceKey = std::tuple<TileIndex, StationID, SourceType, SourceID>;
+
+	uint removed = 0;
+	std::map<SourceKey, std::vector<CargoPacket *>> candidates;
+	for (StationCargoPacketMap::MapIterator map_it = this->packets.begin(); map_it != this->packets.end(); ++map_it) {
+		StationCargoPacketMap::List &list = map_it->second;
+		if (list.size() < 2) continue;
+
+		candidates.clear();
+		for (StationCargoPacketMap::ListIterator it = list.begin(); it != list.end();) {
+			CargoPacket *cp = *it;
+			std::vector<CargoPacket *> &same_source = candidates[{cp->source_xy, cp->first_station, cp->source_type, cp->source_id}];
+			auto merged = std::find_if(same_source.begin(), same_source.end(), [&](CargoPacket *icp) { return this->TryMergeAged(icp, cp, age_tolerance); });
+			if (merged != same_source.end()) {
+				it = list.erase(it);
+				++removed;
+			} else {
+				same_source.push_back(cp);
+				++it;
+			}
+		}
+	}
+	return removed;
+}
+
 /**
  * Shifts cargo from the front of the packet list for a specific station and
  * applies some action to it.
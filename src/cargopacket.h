@@ -355,6 +355,8 @@ protected:
 
 	Money feeder_share;                     ///< Cache for the feeder share.
 	uint action_counts[NUM_MOVE_TO_ACTION]; ///< Counts of cargo to be transferred, delivered, kept and loaded.
+	uint16_t unapplied_periods = 0;          ///< NOSAVE: Cargo aging periods already in the cache, but not yet added to the packets.
+	uint16_t max_periods_in_transit = UINT16_MAX; ///< NOSAVE: Upper bound of the periods in transit stored in the packets.
 
 	template <class Taction>
 	void ShiftCargo(Taction action);
@@ -475,6 +477,7 @@ public:
 	void Append(CargoPacket *cp, MoveToAction action = MTA_KEEP);
 
 	void AgeCargo();
+	void ApplyAging();
 
 	void InvalidateCache();
 
@@ -533,6 +536,8 @@ protected:
 
 	uint reserved_count; ///< Amount of cargo being reserved for loading.
 
+	bool TryMergeAged(CargoPacket *icp, CargoPacket *cp, uint16_t age_tolerance);
+
 public:
 	/** The super class ought to know what it's doing. */
 	friend class CargoList<StationCargoList, StationCargoPacketMap>;
@@ -618,17 +623,20 @@ public:
 	uint Truncate(uint max_move = UINT_MAX, StationCargoAmountMap *cargo_per_source = nullptr);
 	uint Reroute(uint max_move, StationCargoList *dest, StationID avoid, StationID avoid2, const GoodsEntry *ge);
 
+	uint Compact(uint16_t age_tolerance);
+
 	/**
 	 * Are the two CargoPackets mergeable in the context of
 	 * a list of CargoPackets for a Station?
 	 * @param cp1 First CargoPacket.
 	 * @param cp2 Second CargoPacket.
+	 * @param age_tolerance Maximum difference in cargo aging periods.
 	 * @return True if they are mergeable.
 	 */
-	static bool AreMergable(const CargoPacket *cp1, const CargoPacket *cp2)
+	static bool AreMergable(const CargoPacket *cp1, const CargoPacket *cp2, uint16_t age_tolerance = 0)
 	{
 		return cp1->source_xy == cp2->source_xy &&
-				cp1->periods_in_transit == cp2->periods_in_transit &&
+				Delta(cp1->periods_in_transit, cp2->periods_in_transit) <= age_tolerance &&
 				cp1->source_type == cp2->source_type &&
 				cp1->first_station == cp2->first_station &&
 				cp1->source_id == cp2->source_id;
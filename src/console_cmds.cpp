@@ -38,6 +38,10 @@
 #include "newgrf_profiling.h"
 #include "console_func.h"
 #include "engine_base.h"
+#include "station_base.h"
+#include "linkgraph/linkgraphschedule.h"
+#include "linkgraph/linkgraphjob.h"
+#include "vehicle_base.h"
 #include "road.h"
 #include "rail.h"
 #include "game/game.hpp"
@@ -2738,13 +2742,60 @@ static void ConDumpCargoTypes()
 	}
 }
 
+static void ConDumpCargoPackets()
+{
+	size_t station_lists = 0;
+	size_t station_packets = 0;
+	uint64_t station_cargo = 0;
+	for (const Station *st : Station::Iterate()) {
+		for (const GoodsEntry &ge : st->goods) {
+			if (!ge.HasData() || ge.GetData().cargo.TotalCount() == 0) continue;
+			station_lists++;
+			station_packets += ge.GetData().cargo.Packets()->size();
+			station_cargo += ge.GetData().cargo.AvailableCount();
+		}
+	}
+
+	size_t vehicle_lists = 0;
+	size_t vehicle_packets = 0;
+	uint64_t vehicle_cargo = 0;
+	for (const Vehicle *v : Vehicle::Iterate()) {
+		if (v->cargo.TotalCount() == 0) continue;
+		vehicle_lists++;
+		vehicle_packets += v->cargo.Packets()->size();
+		vehicle_cargo += v->cargo.TotalCount();
+	}
+
+	IConsolePrint(CC_DEFAULT, "  Pool: {} of {} packets in use, {} allocated, {} KiB",
+			_cargopacket_pool.items, CargoPacketPool::MAX_SIZE, _cargopacket_pool.size,
+			_cargopacket_pool.items * sizeof(CargoPacket) / 1024);
+	IConsolePrint(CC_DEFAULT, "  Stations: {} packets in {} lists, {} cargo, {} cargo per packet",
+			station_packets, station_lists, station_cargo, station_packets == 0 ? 0 : station_cargo / station_packets);
+	IConsolePrint(CC_DEFAULT, "  Vehicles: {} packets in {} lists, {} cargo, {} cargo per packet",
+			vehicle_packets, vehicle_lists, vehicle_cargo, vehicle_packets == 0 ? 0 : vehicle_cargo / vehicle_packets);
+}
+
+static void ConDumpLinkGraphJobs()
+{
+	const auto &running = LinkGraphSchedule::instance.Running();
+	for (const LinkGraphJob *job : running) {
+		IConsolePrint(CC_DEFAULT, "  Job {}: link graph {}, cargo {}, {} nodes, estimated peak memory {} KiB, join date {}{}",
+				job->index, job->LinkGraphIndex(), job->Cargo(), job->Size(), job->EstimatedMemoryUsage() / 1024,
+				job->JoinDate().base(), job->IsJobCompleted() ? ", completed" : "");
+	}
+
+	uint16_t budget = _settings_game.linkgraph.max_job_memory;
+	IConsolePrint(CC_DEFAULT, "  {} running jobs, estimated peak memory {} KiB, budget {}",
+			running.size(), LinkGraphSchedule::instance.RunningMemoryUsage() / 1024,
+			budget == 0 ? std::string("unlimited") : fmt::format("{} MiB", budget));
+}
 
 DEF_CONSOLE_CMD(ConDumpInfo)
 {
 	if (argc != 2) {
 		IConsolePrint(CC_HELP, "Dump debugging information.");
-		IConsolePrint(CC_HELP, "Usage: 'dump_info roadtypes|railtypes|cargotypes'.");
-		IConsolePrint(CC_HELP, "  Show information about road/tram types, rail types or cargo types.");
+		IConsolePrint(CC_HELP, "Usage: 'dump_info roadtypes|railtypes|cargotypes|cargopackets|linkgraphjobs'.");
+		IConsolePrint(CC_HELP, "  Show information about road/tram types, rail types, cargo types, cargo packet usage or link graph jobs.");
 		return true;
 	}
 
@@ -2763,6 +2814,16 @@ DEF_CONSOLE_CMD(ConDumpInfo)
 		return true;
 	}
 
+	if (StrEqualsIgnoreCase(argv[1], "cargopackets")) {
+		ConDumpCargoPackets();
+		return true;
+	}
+
+	if (StrEqualsIgnoreCase(argv[1], "linkgraphjobs")) {
+		ConDumpLinkGraphJobs();
+		return true;
+	}
+
 	return false;
 }
 
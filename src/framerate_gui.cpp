@@ -1095,6 +1095,26 @@ void ConPrintFramerate()
 	}
 }
 
+/**
+ * Get the average processing time of a performance element over the most recent data points.
+ * @param elem The element to get the average of.
+ * @return The average duration in milliseconds, or 0 when nothing was measured.
+ */
+double GetPerformanceAverageDuration(PerformanceElement elem)
+{
+	return _pf_data[elem].GetAverageDurationMilliseconds(NUM_FRAMERATE_POINTS / 8);
+}
+
+/**
+ * Get the current rate of a performance element, based on approximately the past second.
+ * @param elem The element to get the rate of.
+ * @return The rate in cycles per second.
+ */
+double GetPerformanceRate(PerformanceElement elem)
+{
+	return _pf_data[elem].GetRate();
+}
+
 /**
  * This drains the PFE_SOUND measurement data queue into _pf_data.
  * PFE_SOUND measurements are made by the mixer thread and so cannot be stored
@@ -122,5 +122,7 @@ public:
 
 void ShowFramerateWindow();
 void ProcessPendingPerformanceMeasurements();
+double GetPerformanceAverageDuration(PerformanceElement elem);
+double GetPerformanceRate(PerformanceElement elem);
 
 #endif /* FRAMERATE_TYPE_H */
@@ -3,12 +3,31 @@
 #include "../stdafx.h"
 #include "demands.h"
 #include "../core/math_func.hpp"
+#include "../core/kdtree.hpp"
+#include "../debug.h"
 #include <queue>
 
 #include "../safeguards.h"
 
 typedef std::queue<NodeID> NodeList;
 
+/** Position of a node with demand, for looking up nodes near a supplying one. */
+struct DemandNodePosition {
+	NodeID node; ///< The node.
+	uint16_t x;  ///< X coordinate of the node's station.
+	uint16_t y;  ///< Y coordinate of the node's station.
+};
+
+/** Coordinate accessor for the demand node k-d tree. */
+struct Kdtree_DemandNodeXYFunc {
+	inline uint16_t operator()(const DemandNodePosition &pos, int dim)
+	{
+		return (dim == 0) ? pos.x : pos.y;
+	}
+};
+
+using DemandNodeKdtree = Kdtree<DemandNodePosition, Kdtree_DemandNodeXYFunc, uint16_t, int>;
+
 /**
  * Scale various things according to symmetric/asymmetric distribution.
  */
@@ -28,7 +47,7 @@ public:
 	 *                 increase with the supply of the remote station.
 	 */
 	inline SymmetricScaler(uint mod_size) : mod_size(mod_size), supply_sum(0),
-		demand_per_node(0)
+		max_supply(0), demand_per_node(0)
 	{}
 
 	/**
@@ -38,6 +57,7 @@ public:
 	inline void AddNode(const Node &node)
 	{
 		this->supply_sum += node.base.supply;
+		this->max_supply = std::max(this->max_supply, node.base.supply);
 	}
 
 	/**
@@ -61,6 +81,16 @@ public:
 		return std::max(from.base.supply * std::max(1U, to.base.supply) * this->mod_size / 100 / this->demand_per_node, 1U);
 	}
 
+	/**
+	 * Get the highest effective supply a node can have towards any other node.
+	 * @param from The supplying node.
+	 * @return Upper bound of EffectiveSupply(from, to) for all nodes.
+	 */
+	inline uint MaxEffectiveSupply(const Node &from)
+	{
+		return std::max(from.base.supply * std::max(1U, this->max_supply) * this->mod_size / 100 / this->demand_per_node, 1U);
+	}
+
 	/**
 	 * Check if there is any acceptance left for this node. In symmetric distribution
 	 * nodes only accept anything if they also supply something. So if
@@ -78,6 +108,7 @@ public:
 private:
 	uint mod_size;        ///< Size modifier. Determines how much demands increase with the supply of the remote station.
 	uint supply_sum;      ///< Sum of all supplies in the component.
+	uint max_supply;      ///< Highest supply of any node in the component.
 	uint demand_per_node; ///< Mean demand associated with each node.
 };
 
@@ -112,6 +143,15 @@ public:
 		return from.base.supply;
 	}
 
+	/**
+	 * Get the highest effective supply a node can have towards any other node.
+	 * @param from The supplying node.
+	 */
+	inline uint MaxEffectiveSupply(const Node &from)
+	{
+		return from.base.supply;
+	}
+
 	/**
 	 * Check if there is any acceptance left for this node. In asymmetric distribution
 	 * nodes always accept as long as their demand > 0.
@@ -156,6 +196,57 @@ inline void Scaler::SetDemands(LinkGraphJob &job, NodeID from_id, NodeID to_id,
 	job[from_id].DeliverSupply(to_id, demand_forw);
 }
 
+/**
+ * Calculate the demand a node hands out to another one before any leftovers
+ * are distributed. The effective supply is divided by a divisor which grows
+ * with the distance between the nodes.
+ * @param supply Effective supply of the supplying node towards the receiving one.
+ * @param from Location of the supplying node.
+ * @param to Location of the receiving node.
+ * @return Demand for the pair, or 0 if the supply is too small or the nodes are too far apart.
+ */
+uint DemandCalculator::FirstPassDemand(int32_t supply, TileIndex from, TileIndex to) const
+{
+	constexpr int32_t divisor_scale = 16;
+
+	int32_t scaled_distance = this->base_distance;
+	if (this->mod_dist > 0) {
+		const int32_t distance = DistanceMaxPlusManhattan(from, to);
+		/* Scale distance around base_distance by (mod_dist * (100 / 1024)).
+		 * mod_dist may be > 1024, so clamp result to be non-negative */
+		scaled_distance = std::max(0, this->base_distance + (((distance - this->base_distance) * this->mod_dist) / 1024));
+	}
+
+	/* Scale the accuracy by distance around accuracy / 2 */
+	const int32_t divisor = divisor_scale + ((this->accuracy * scaled_distance * divisor_scale) / (this->base_distance * 2));
+	assert(divisor >= divisor_scale);
+
+	/* At first only distribute demand if
+	 * effective supply / accuracy divisor >= 1
+	 * Others are too small or too far away to be considered. */
+	if (divisor > (supply * divisor_scale)) return 0;
+	return (supply * divisor_scale) / divisor;
+}
+
+/**
+ * Get the distance up to which FirstPassDemand may hand out demand for the
+ * given effective supply. This errs on the side of being too large, so that
+ * no pair of nodes which would get demand is missed.
+ * @param supply Highest effective supply of the supplying node.
+ * @return Upper bound for DistanceMaxPlusManhattan of pairs getting any demand, or -1 if no pair gets any.
+ */
+int64_t DemandCalculator::NearbyDistance(int32_t supply) const
+{
+	/* FirstPassDemand is non-zero only if accuracy * scaled_distance / (2 * base_distance) < supply. */
+	const int64_t max_scaled_distance = static_cast<int64_t>(supply) * 2 * this->base_distance / this->accuracy;
+
+	/* Without effect of distance all pairs are equal. */
+	if (this->mod_dist == 0) return max_scaled_distance >= this->base_distance ? INT64_MAX : -1;
+
+	/* Invert the scaling of the distance, rounding up. */
+	return this->base_distance + (max_scaled_distance - this->base_distance + 1) * 1024 / this->mod_dist + 1;
+}
+
 /**
  * Do the actual demand calculation, called from constructor.
  * @param job Job to calculate the demands for.
@@ -208,27 +299,8 @@ void DemandCalculator::CalcDemand(LinkGraphJob &job, Tscaler scaler)
 			int32_t supply = scaler.EffectiveSupply(job[from_id], job[to_id]);
 			assert(supply > 0);
 
-			constexpr int32_t divisor_scale = 16;
-
-			int32_t scaled_distance = this->base_distance;
-			if (this->mod_dist > 0) {
-				const int32_t distance = DistanceMaxPlusManhattan(job[from_id].base.xy, job[to_id].base.xy);
-				/* Scale distance around base_distance by (mod_dist * (100 / 1024)).
-				 * mod_dist may be > 1024, so clamp result to be non-negative */
-				scaled_distance = std::max(0, this->base_distance + (((distance - this->base_distance) * this->mod_dist) / 1024));
-			}
-
-			/* Scale the accuracy by distance around accuracy / 2 */
-			const int32_t divisor = divisor_scale + ((this->accuracy * scaled_distance * divisor_scale) / (this->base_distance * 2));
-			assert(divisor >= divisor_scale);
-
-			uint demand_forw = 0;
-			if (divisor <= (supply * divisor_scale)) {
-				/* At first only distribute demand if
-				 * effective supply / accuracy divisor >= 1
-				 * Others are too small or too far away to be considered. */
-				demand_forw = (supply * divisor_scale) / divisor;
-			} else if (++chance > this->accuracy * num_demands * num_supplies) {
+			uint demand_forw = this->FirstPassDemand(supply, job[from_id].base.xy, job[to_id].base.xy);
+			if (demand_forw == 0 && ++chance > this->accuracy * num_demands * num_supplies) {
 				/* After some trying, if there is still supply left, distribute
 				 * demand also to other nodes. */
 				demand_forw = 1;
@@ -255,6 +327,135 @@ void DemandCalculator::CalcDemand(LinkGraphJob &job, Tscaler scaler)
 	}
 }
 
+/**
+ * Calculate the demands, but only look at nodes near enough to a supplying
+ * node to get any distance-scaled demand from it. Whatever supply is left
+ * after that is handed out to all nodes with demand in single units, like
+ * CalcDemand does once it gives up on finding better pairs. So nodes which are
+ * too far away get the same kind of demand as in CalcDemand, only the order in
+ * which the leftovers are handed out differs.
+ * @param job Job to calculate the demands for.
+ * @tparam Tscaler Scaler to be used for scaling demands.
+ */
+template <class Tscaler>
+void DemandCalculator::CalcNearbyDemand(LinkGraphJob &job, Tscaler scaler)
+{
+	std::vector<NodeID> supplying;
+	std::vector<DemandNodePosition> positions;
+
+	for (NodeID node = 0; node < job.Size(); node++) {
+		scaler.AddNode(job[node]);
+		if (job[node].base.supply > 0) supplying.push_back(node);
+		if (job[node].base.demand > 0) {
+			positions.push_back({node, static_cast<uint16_t>(TileX(job[node].base.xy)), static_cast<uint16_t>(TileY(job[node].base.xy))});
+		}
+	}
+
+	if (supplying.empty() || positions.empty()) return;
+
+	scaler.SetDemandPerNode(static_cast<uint>(positions.size()));
+
+	DemandNodeKdtree tree;
+	tree.Build(positions.begin(), positions.end());
+
+	/* Find the nodes near enough to each supplying node to get any demand from it. */
+	std::vector<std::vector<NodeID>> nearby(job.Size());
+	NodeList supplies;
+	NodeList leftovers;
+	for (NodeID from_id : supplying) {
+		const Node &from = job[from_id];
+		const int64_t max_distance = this->NearbyDistance(scaler.MaxEffectiveSupply(from));
+		if (max_distance >= 0) {
+			/* DistanceMaxPlusManhattan is at least twice the distance along either axis. */
+			const int64_t radius = std::min<int64_t>(max_distance / 2, std::max(Map::SizeX(), Map::SizeY()));
+			const int64_t x = TileX(from.base.xy);
+			const int64_t y = TileY(from.base.xy);
+			std::vector<NodeID> &near = nearby[from_id];
+			tree.FindContained(
+					static_cast<uint16_t>(std::max<int64_t>(0, x - radius)), static_cast<uint16_t>(std::max<int64_t>(0, y - radius)),
+					static_cast<uint16_t>(std::min<int64_t>(x + radius + 1, Map::SizeX())), static_cast<uint16_t>(std::min<int64_t>(y + radius + 1, Map::SizeY())),
+					[&](const DemandNodePosition &pos) {
+						if (pos.node != from_id && DistanceMaxPlusManhattan(from.base.xy, job[pos.node].base.xy) <= max_distance) near.push_back(pos.node);
+					});
+			/* Don't let the layout of the tree influence the result. */
+			std::sort(near.begin(), near.end());
+		}
+
+		if (nearby[from_id].empty()) {
+			leftovers.push(from_id);
+		} else {
+			supplies.push(from_id);
+		}
+	}
+
+	/* Hand out distance-scaled demand to nearby nodes until none of them takes any more. */
+	while (!supplies.empty()) {
+		NodeID from_id = supplies.front();
+		supplies.pop();
+
+		bool delivered = false;
+		for (NodeID to_id : nearby[from_id]) {
+			if (job[from_id].undelivered_supply == 0) break;
+			/* Symmetric demand and the node's own supply also use up its demand, so always check. */
+			if (!scaler.HasDemandLeft(job[to_id])) continue;
+
+			int32_t supply = scaler.EffectiveSupply(job[from_id], job[to_id]);
+			assert(supply > 0);
+
+			uint demand_forw = std::min(this->FirstPassDemand(supply, job[from_id].base.xy, job[to_id].base.xy), job[from_id].undelivered_supply);
+			if (demand_forw == 0) continue;
+
+			scaler.SetDemands(job, from_id, to_id, demand_forw);
+			delivered = true;
+		}
+
+		if (job[from_id].undelivered_supply == 0) continue;
+		if (delivered) {
+			supplies.push(from_id);
+		} else {
+			leftovers.push(from_id);
+		}
+	}
+
+	/* Distribute the leftovers among all nodes which still have demand. */
+	NodeList demands;
+	for (const DemandNodePosition &pos : positions) {
+		if (scaler.HasDemandLeft(job[pos.node])) demands.push(pos.node);
+	}
+	uint num_demands = static_cast<uint>(demands.size());
+
+	while (!leftovers.empty() && !demands.empty()) {
+		NodeID from_id = leftovers.front();
+		leftovers.pop();
+		if (job[from_id].undelivered_supply == 0) continue;
+
+		for (uint i = 0; i < num_demands; ++i) {
+			assert(!demands.empty());
+			NodeID to_id = demands.front();
+			demands.pop();
+			if (from_id == to_id) {
+				/* Only one node with supply and demand left */
+				if (demands.empty() && leftovers.empty()) return;
+
+				demands.push(to_id);
+				continue;
+			}
+
+			scaler.SetDemands(job, from_id, to_id, 1);
+
+			if (scaler.HasDemandLeft(job[to_id])) {
+				demands.push(to_id);
+			} else {
+				num_demands--;
+			}
+
+			if (job[from_id].undelivered_supply == 0) break;
+		}
+
+		if (job[from_id].undelivered_supply != 0) leftovers.push(from_id);
+	}
+}
+
 /**
  * Create the DemandCalculator and immediately do the calculation.
  * @param job Job to calculate the demands for.
@@ -279,15 +480,29 @@ DemandCalculator::DemandCalculator(LinkGraphJob &job) :
 		this->mod_dist = 100 + ((over100 * over100) / 12);
 	}
 
+	const bool nearby = settings.demand_mode == DM_NEARBY;
+	const auto start = std::chrono::steady_clock::now();
+
 	switch (settings.GetDistributionType(cargo)) {
 		case DT_SYMMETRIC:
-			this->CalcDemand<SymmetricScaler>(job, SymmetricScaler(settings.demand_size));
+			if (nearby) {
+				this->CalcNearbyDemand<SymmetricScaler>(job, SymmetricScaler(settings.demand_size));
+			} else {
+				this->CalcDemand<SymmetricScaler>(job, SymmetricScaler(settings.demand_size));
+			}
 			break;
 		case DT_ASYMMETRIC:
-			this->CalcDemand<AsymmetricScaler>(job, AsymmetricScaler());
+			if (nearby) {
+				this->CalcNearbyDemand<AsymmetricScaler>(job, AsymmetricScaler());
+			} else {
+				this->CalcDemand<AsymmetricScaler>(job, AsymmetricScaler());
+			}
 			break;
 		default:
 			/* Nothing to do. */
-			break;
+			return;
 	}
+
+	Debug(misc, 3, "Calculated {} demands for {} nodes in {} us", nearby ? "nearby" : "exact", job.Size(),
+			std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
 }
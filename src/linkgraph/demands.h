@@ -18,8 +18,14 @@ private:
 	int32_t mod_dist;      ///< Distance modifier, determines how much demands decrease with distance.
 	int32_t accuracy;      ///< Accuracy of the calculation.
 
+	uint FirstPassDemand(int32_t supply, TileIndex from, TileIndex to) const;
+	int64_t NearbyDistance(int32_t supply) const;
+
 	template <class Tscaler>
 	void CalcDemand(LinkGraphJob &job, Tscaler scaler);
+
+	template <class Tscaler>
+	void CalcNearbyDemand(LinkGraphJob &job, Tscaler scaler);
 };
 
 /**
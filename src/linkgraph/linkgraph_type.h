@@ -31,6 +31,16 @@ enum DistributionType : uint8_t {
 	DT_END = 3
 };
 
+/**
+ * Ways of calculating the demands between the nodes of a link graph.
+ */
+enum DemandMode : uint8_t {
+	DM_BEGIN = 0,
+	DM_EXACT = 0,  ///< Consider every pair of nodes.
+	DM_NEARBY = 1, ///< Only hand out distance-scaled demand to nodes near enough to get any; the rest only gets leftovers.
+	DM_END,
+};
+
 /**
  * Special modes for updating links. 'Restricted' means that vehicles with
  * 'no loading' orders are serving the link. If a link is only served by
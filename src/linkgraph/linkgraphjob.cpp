@@ -190,6 +190,27 @@ void LinkGraphJob::Init()
 	}
 }
 
+/**
+ * Estimate the peak memory a job for the given link graph will need. The
+ * estimate only depends on the shape of the link graph, so it is the same on
+ * all clients and can be used for scheduling decisions.
+ * @param lg Link graph to be calculated.
+ * @return Estimated memory usage in bytes.
+ */
+/* static */ size_t LinkGraphJob::EstimateMemoryUsage(const LinkGraph &lg)
+{
+	size_t size = lg.Size();
+	size_t edges = 0;
+	for (NodeID node = 0; node < lg.Size(); ++node) edges += lg[node].edges.size();
+
+	/* The job holds a copy of the link graph plus annotations for each node,
+	 * edge and pair of nodes. The MCF passes create up to one path per pair
+	 * of nodes on top of that. */
+	return size * (sizeof(LinkGraph::BaseNode) + sizeof(NodeAnnotation)) +
+			edges * (sizeof(LinkGraph::BaseEdge) + sizeof(EdgeAnnotation)) +
+			size * size * (sizeof(DemandAnnotation) + sizeof(Path));
+}
+
 /**
  * Add this path as a new child to the given base path, thus making this path
  * a "fork" of the base path.
@@ -185,6 +185,14 @@ public:
 
 	void Init();
 
+	static size_t EstimateMemoryUsage(const LinkGraph &lg);
+
+	/**
+	 * Get the estimated peak memory usage of this job.
+	 * @return Memory usage in bytes.
+	 */
+	inline size_t EstimatedMemoryUsage() const { return LinkGraphJob::EstimateMemoryUsage(this->link_graph); }
+
 	/**
 	 * Check if job has actually finished.
 	 * This is allowed to spuriously return an incorrect value.
@@ -41,6 +41,16 @@ void LinkGraphSchedule::SpawnNext()
 		if (next == first) return;
 	}
 	assert(next == LinkGraph::Get(next->index));
+
+	/* Leave the graph at the front of the queue if it doesn't fit into the
+	 * memory budget next to the running jobs, so it is first in line once
+	 * they have been joined. */
+	uint64_t budget = static_cast<uint64_t>(_settings_game.linkgraph.max_job_memory) << 20;
+	if (budget != 0 && !this->running.empty() &&
+			this->RunningMemoryUsage() + LinkGraphJob::EstimateMemoryUsage(*next) > budget) {
+		return;
+	}
+
 	this->schedule.pop_front();
 	if (LinkGraphJob::CanAllocateItem()) {
 		LinkGraphJob *job = new LinkGraphJob(*next);
@@ -51,6 +61,17 @@ void LinkGraphSchedule::SpawnNext()
 	}
 }
 
+/**
+ * Get the estimated memory usage of all running jobs.
+ * @return Memory usage in bytes.
+ */
+size_t LinkGraphSchedule::RunningMemoryUsage() const
+{
+	size_t usage = 0;
+	for (const LinkGraphJob *job : this->running) usage += job->EstimatedMemoryUsage();
+	return usage;
+}
+
 /**
  * Check if the next job is supposed to be finished, but has not yet completed.
  * @return True if job should be finished by now but is still running, false if not.
@@ -55,6 +55,7 @@ public:
 	static void Clear();
 
 	void SpawnNext();
+	size_t RunningMemoryUsage() const;
 	bool IsJoinWithUnfinishedJobDue() const;
 	void JoinNext();
 	void SpawnAll();
@@ -75,6 +76,12 @@ public:
 	 * @param lg Link graph to be removed.
 	 */
 	void Unqueue(LinkGraph *lg) { this->schedule.remove(lg); }
+
+	/**
+	 * Get the currently running jobs, in the order they will be joined.
+	 * @return Running jobs.
+	 */
+	const std::list<LinkGraphJob *> &Running() const { return this->running; }
 };
 
 void StateGameLoop_LinkGraphPauseControl();
@@ -32,10 +32,24 @@
 	const Order *first = v->orders->GetNextDecisionNode(v->GetOrder(v->cur_implicit_order_index), 0);
 	if (first == nullptr) return;
 
+	bool has_cargo = v->last_loading_station != INVALID_STATION;
+
 	HopSet seen_hops;
-	LinkRefresher refresher(v, &seen_hops, allow_merge, is_full_loading);
+	Prediction prediction{{first, has_cargo, {}}, true};
+	LinkRefresher refresher(v, &seen_hops, &prediction, allow_merge, is_full_loading);
+
+	/* Without refits the walk over the orders only depends on the orders
+	 * themselves, so a previous prediction for the same order list can be
+	 * replayed. The stats are still refreshed with the current consist. */
+	const OrderList::PredictedLinks *cached = v->orders->GetPredictedLinks(first, has_cargo);
+	if (cached != nullptr) {
+		for (const auto &[cur, next] : cached->links) refresher.RefreshStats(cur, next);
+		return;
+	}
+
+	refresher.RefreshLinks(first, first, has_cargo ? 1 << HAS_CARGO : 0);
 
-	refresher.RefreshLinks(first, first, v->last_loading_station != INVALID_STATION ? 1 << HAS_CARGO : 0);
+	if (prediction.cacheable) v->orders->AddPredictedLinks(std::move(prediction.links));
 }
 
 /**
@@ -63,11 +77,13 @@ bool LinkRefresher::Hop::operator<(const Hop &other) const
  * @param vehicle Vehicle to refresh links for.
  * @param seen_hops Set of hops already seen. This is shared between this
  *                  refresher and all its children.
+ * @param prediction Links refreshed so far. This is shared between this
+ *                   refresher and all its children.
  * @param allow_merge If the refresher is allowed to merge or extend link graphs.
  * @param is_full_loading If the vehicle is full loading.
  */
-LinkRefresher::LinkRefresher(Vehicle *vehicle, HopSet *seen_hops, bool allow_merge, bool is_full_loading) :
-	vehicle(vehicle), seen_hops(seen_hops), cargo(INVALID_CARGO), allow_merge(allow_merge),
+LinkRefresher::LinkRefresher(Vehicle *vehicle, HopSet *seen_hops, Prediction *prediction, bool allow_merge, bool is_full_loading) :
+	vehicle(vehicle), seen_hops(seen_hops), prediction(prediction), cargo(INVALID_CARGO), allow_merge(allow_merge),
 	is_full_loading(is_full_loading)
 {
 	/* Assemble list of capacities and set last loading stations to 0. */
@@ -265,6 +281,8 @@ void LinkRefresher::RefreshLinks(const Order *cur, const Order *next, uint8_t fl
 	while (next != nullptr) {
 
 		if ((next->IsType(OT_GOTO_DEPOT) || next->IsType(OT_GOTO_STATION)) && next->IsRefit()) {
+			/* Refit capacities depend on the consist, so don't cache this prediction. */
+			this->prediction->cacheable = false;
 			SetBit(flags, WAS_REFIT);
 			if (!next->IsAutoRefit()) {
 				this->HandleRefit(next->GetRefitCargo());
@@ -314,6 +332,7 @@ void LinkRefresher::RefreshLinks(const Order *cur, const Order *next, uint8_t fl
 			if (cur->CanLeaveWithCargo(HasBit(flags, HAS_CARGO))) {
 				SetBit(flags, HAS_CARGO);
 				this->RefreshStats(cur, next);
+				this->prediction->links.links.emplace_back(cur, next);
 			} else {
 				ClrBit(flags, HAS_CARGO);
 			}
@@ -77,15 +77,25 @@ protected:
 	typedef std::vector<RefitDesc> RefitList;
 	typedef std::set<Hop> HopSet;
 
+	/**
+	 * Links refreshed during a run, to be cached in the order list. This is
+	 * shared between all Refreshers of the same run.
+	 */
+	struct Prediction {
+		OrderList::PredictedLinks links; ///< Links refreshed so far.
+		bool cacheable;                  ///< Whether the links only depend on the orders, i.e. no refit was encountered.
+	};
+
 	Vehicle *vehicle;           ///< Vehicle for which the links should be refreshed.
 	CargoArray capacities{}; ///< Current added capacities per cargo ID in the consist.
 	RefitList refit_capacities; ///< Current state of capacity remaining from previous refits versus overall capacity per vehicle in the consist.
 	HopSet *seen_hops;          ///< Hops already seen. If the same hop is seen twice we stop the algorithm. This is shared between all Refreshers of the same run.
+	Prediction *prediction;     ///< Links refreshed in this run. This is shared between all Refreshers of the same run.
 	CargoID cargo;              ///< Cargo given in last refit order.
 	bool allow_merge;           ///< If the refresher is allowed to merge or extend link graphs.
 	bool is_full_loading;       ///< If the vehicle is full loading.
 
-	LinkRefresher(Vehicle *v, HopSet *seen_hops, bool allow_merge, bool is_full_loading);
+	LinkRefresher(Vehicle *v, HopSet *seen_hops, Prediction *prediction, bool allow_merge, bool is_full_loading);
 
 	bool HandleRefit(CargoID refit_cargo);
 	void ResetRefit();
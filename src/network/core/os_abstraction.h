@@ -91,6 +91,12 @@ typedef unsigned long in_addr_t;
 #	include <sys/time.h>
 #	include <netdb.h>
 
+/* Linux can wait for many sockets at once without select's limits. */
+#	if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#		include <sys/epoll.h>
+#		define HAVE_EPOLL
+#	endif
+
 #   if defined(__EMSCRIPTEN__)
 /* Emscripten doesn't support AI_ADDRCONFIG and errors out on it. */
 #		undef AI_ADDRCONFIG
@@ -38,10 +38,67 @@ NetworkTCPSocketHandler::~NetworkTCPSocketHandler()
  */
 void NetworkTCPSocketHandler::CloseSocket()
 {
+#ifdef HAVE_EPOLL
+	/* Closing the socket does not remove it from the epoll instance when
+	 * another process, such as a forked save, still has it open. */
+	if (this->epoll_events != 0) {
+		epoll_ctl(this->epoll_instance, EPOLL_CTL_DEL, this->sock, nullptr);
+		this->epoll_events = 0;
+		this->epoll_instance = -1;
+	}
+#endif
+
 	if (this->sock != INVALID_SOCKET) closesocket(this->sock);
 	this->sock = INVALID_SOCKET;
 }
 
+#ifdef HAVE_EPOLL
+/**
+ * Get the events to wait for with epoll.
+ * @param writable Whether the socket is known to be writable.
+ * @return The events; being writable is only waited for when it is not yet known.
+ */
+static uint32_t GetEpollEvents(bool writable)
+{
+	return writable ? EPOLLIN : EPOLLIN | EPOLLOUT;
+}
+
+/**
+ * Start waiting for this socket with epoll.
+ * @param epoll_instance The epoll instance to register the socket with.
+ */
+void NetworkTCPSocketHandler::WatchWithEpoll(int epoll_instance)
+{
+	epoll_event ev{};
+	ev.events = GetEpollEvents(this->writable);
+	ev.data.ptr = this;
+	if (epoll_ctl(epoll_instance, EPOLL_CTL_ADD, this->sock, &ev) < 0) {
+		Debug(net, 0, "epoll_ctl failed: {}", NetworkError::GetLast().AsString());
+		return;
+	}
+	this->epoll_events = ev.events;
+	this->epoll_instance = epoll_instance;
+}
+
+/**
+ * Update the events this socket is waited for with epoll after #writable changed.
+ */
+void NetworkTCPSocketHandler::UpdateEpollEvents()
+{
+	uint32_t events = GetEpollEvents(this->writable);
+	if (this->epoll_events == 0 || this->epoll_events == events) return;
+
+	epoll_event ev{};
+	ev.events = events;
+	ev.data.ptr = this;
+	if (epoll_ctl(this->epoll_instance, EPOLL_CTL_MOD, this->sock, &ev) < 0) {
+		Debug(net, 0, "epoll_ctl failed: {}", NetworkError::GetLast().AsString());
+		return;
+	}
+	this->epoll_events = events;
+}
+#endif /* HAVE_EPOLL */
+
 /**
  * This will put this socket handler in a close state. It will not
  * actually close the OS socket; use CloseSocket for this.
@@ -54,6 +111,7 @@ NetworkRecvStatus NetworkTCPSocketHandler::CloseConnection([[maybe_unused]] bool
 	this->writable = false;
 
 	this->packet_queue.clear();
+	this->send_buffer.clear();
 	this->packet_recv = nullptr;
 
 	return NETWORK_RECV_STATUS_OKAY;
@@ -73,12 +131,28 @@ void NetworkTCPSocketHandler::SendPacket(std::unique_ptr<Packet> &&packet)
 	this->packet_queue.push_back(std::move(packet));
 }
 
+/**
+ * Copy (a part of) a packet into the send buffer.
+ * @param send_buffer The buffer to append to.
+ * @param source      The data to append.
+ * @param amount      The number of bytes to append.
+ * @return The number of bytes that were appended.
+ */
+static ssize_t AppendToSendBuffer(std::vector<uint8_t> *send_buffer, const char *source, size_t amount)
+{
+	send_buffer->insert(send_buffer->end(), source, source + amount);
+	return amount;
+}
+
 /**
  * Sends all the buffered packets out for this client. It stops when:
  *   1) all packets are send (queue is empty)
  *   2) the OS reports back that it can not send any more
  *      data right now (full network-buffer, it happens ;))
  *   3) sending took too long
+ * Many packets, e.g. frame and command packets, are tiny. To not need a
+ * system call for each of them, the queued packets are coalesced into a
+ * buffer that is sent at once.
  * @param closing_down Whether we are closing down the connection.
  * @return \c true if a (part of a) packet could be sent and
  *         the connection is not closed yet.
@@ -89,9 +163,18 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 	if (!this->writable) return SPS_NONE_SENT;
 	if (!this->IsConnected()) return SPS_CLOSED;
 
-	while (!this->packet_queue.empty()) {
-		Packet &p = *this->packet_queue.front();
-		ssize_t res = p.TransferOut<int>(send, this->sock, 0);
+	while (this->HasSendQueue()) {
+		/* Fill the send buffer with as many packets as fit. */
+		while (!this->packet_queue.empty() && this->send_buffer.size() < SEND_BUFFER_SIZE) {
+			Packet &p = *this->packet_queue.front();
+			p.TransferOutWithLimit(AppendToSendBuffer, SEND_BUFFER_SIZE - this->send_buffer.size(), &this->send_buffer);
+
+			/* Is this packet completely in the buffer? */
+			if (p.RemainingBytesToTransfer() != 0) break;
+			this->packet_queue.pop_front();
+		}
+
+		ssize_t res = send(this->sock, reinterpret_cast<const char *>(this->send_buffer.data()), static_cast<int>(this->send_buffer.size()), 0);
 		if (res == -1) {
 			NetworkError err = NetworkError::GetLast();
 			if (!err.WouldBlock()) {
@@ -102,6 +185,11 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 				}
 				return SPS_CLOSED;
 			}
+			/* Not writable until the socket is found to be writable again. */
+			this->writable = false;
+#ifdef HAVE_EPOLL
+			this->UpdateEpollEvents();
+#endif
 			return SPS_PARTLY_SENT;
 		}
 		if (res == 0) {
@@ -110,13 +198,9 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 			return SPS_CLOSED;
 		}
 
-		/* Is this packet sent? */
-		if (p.RemainingBytesToTransfer() == 0) {
-			/* Go to the next packet */
-			this->packet_queue.pop_front();
-		} else {
-			return SPS_PARTLY_SENT;
-		}
+		/* Was everything in the buffer sent? */
+		this->send_buffer.erase(this->send_buffer.begin(), this->send_buffer.begin() + res);
+		if (!this->send_buffer.empty()) return SPS_PARTLY_SENT;
 	}
 
 	return SPS_ALL_SENT;
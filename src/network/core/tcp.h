@@ -30,13 +30,20 @@ enum SendPacketsState {
 /** Base socket handler for all TCP sockets */
 class NetworkTCPSocketHandler : public NetworkSocketHandler {
 private:
+	static const size_t SEND_BUFFER_SIZE = 64 * 1024; ///< Amount of packet data to coalesce into a single send call.
+
 	std::deque<std::unique_ptr<Packet>> packet_queue; ///< Packets that are awaiting delivery. Cannot be std::queue as that does not have a clear() function.
+	std::vector<uint8_t> send_buffer; ///< Data of the packets that are being sent, coalesced so they can be sent with a single call.
 	std::unique_ptr<Packet> packet_recv; ///< Partially received packet
 
 	void EmptyPacketQueue();
 public:
 	SOCKET sock;              ///< The socket currently connected to
 	bool writable;            ///< Can we write to this socket?
+#ifdef HAVE_EPOLL
+	uint32_t epoll_events = 0; ///< The events the socket is waited for with epoll, or 0 when it is not waited for.
+	int epoll_instance = -1;   ///< The epoll instance the socket is registered with, when #epoll_events is not 0.
+#endif
 
 	/**
 	 * Whether this socket is currently bound to a socket.
@@ -46,6 +53,10 @@ public:
 
 	virtual NetworkRecvStatus CloseConnection(bool error = true);
 	void CloseSocket();
+#ifdef HAVE_EPOLL
+	void WatchWithEpoll(int epoll_instance);
+	void UpdateEpollEvents();
+#endif
 
 	virtual void SendPacket(std::unique_ptr<Packet> &&packet);
 	SendPacketsState SendPackets(bool closing_down = false);
@@ -58,7 +69,7 @@ public:
 	 * Whether there is something pending in the send queue.
 	 * @return true when something is pending in the send queue.
 	 */
-	bool HasSendQueue() { return !this->packet_queue.empty(); }
+	bool HasSendQueue() { return !this->packet_queue.empty() || !this->send_buffer.empty(); }
 
 	NetworkTCPSocketHandler(SOCKET s = INVALID_SOCKET);
 	~NetworkTCPSocketHandler();
@@ -95,6 +95,9 @@ NetworkRecvStatus NetworkAdminSocketHandler::HandlePacket(Packet &p)
 		case ADMIN_PACKET_SERVER_PONG:            return this->Receive_SERVER_PONG(p);
 		case ADMIN_PACKET_SERVER_AUTH_REQUEST:    return this->Receive_SERVER_AUTH_REQUEST(p);
 		case ADMIN_PACKET_SERVER_ENABLE_ENCRYPTION: return this->Receive_SERVER_ENABLE_ENCRYPTION(p);
+		case ADMIN_PACKET_SERVER_STATIONS:        return this->Receive_SERVER_STATIONS(p);
+		case ADMIN_PACKET_SERVER_PERFORMANCE:     return this->Receive_SERVER_PERFORMANCE(p);
+		case ADMIN_PACKET_SERVER_VEHICLES:        return this->Receive_SERVER_VEHICLES(p);
 
 		default:
 			Debug(net, 0, "[tcp/admin] Received invalid packet type {} from '{}' ({})", type, this->admin_name, this->admin_version);
@@ -173,3 +176,6 @@ NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_RCON_END(Packet &) {
 NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_PONG(Packet &) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_PONG); }
 NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_AUTH_REQUEST(Packet &) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_AUTH_REQUEST); }
 NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_ENABLE_ENCRYPTION(Packet &) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_ENABLE_ENCRYPTION); }
+NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_STATIONS(Packet &) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_STATIONS); }
+NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_PERFORMANCE(Packet &) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_PERFORMANCE); }
+NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_VEHICLES(Packet &) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_VEHICLES); }
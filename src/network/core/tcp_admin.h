@@ -65,6 +65,9 @@ enum PacketAdminType : uint8_t {
 	ADMIN_PACKET_SERVER_CMD_LOGGING,     ///< The server gives the admin copies of incoming command packets.
 	ADMIN_PACKET_SERVER_AUTH_REQUEST,    ///< The server gives the admin the used authentication method and required parameters.
 	ADMIN_PACKET_SERVER_ENABLE_ENCRYPTION, ///< The server tells that authentication has completed and requests to enable encryption with the keys of the last \c ADMIN_PACKET_ADMIN_AUTH_RESPONSE.
+	ADMIN_PACKET_SERVER_STATIONS,        ///< The server gives the admin the stations that changed.
+	ADMIN_PACKET_SERVER_PERFORMANCE,     ///< The server gives the admin its performance measurements.
+	ADMIN_PACKET_SERVER_VEHICLES,        ///< The server gives the admin the positions of the vehicles that moved.
 
 	INVALID_ADMIN_PACKET = 0xFF,         ///< An invalid marker for admin packets.
 };
@@ -89,6 +92,9 @@ enum AdminUpdateType {
 	ADMIN_UPDATE_CMD_NAMES,       ///< The admin would like a list of all DoCommand names.
 	ADMIN_UPDATE_CMD_LOGGING,     ///< The admin would like to have DoCommand information.
 	ADMIN_UPDATE_GAMESCRIPT,      ///< The admin would like to have gamescript messages.
+	ADMIN_UPDATE_STATIONS,        ///< Updates about the stations that changed.
+	ADMIN_UPDATE_PERFORMANCE,     ///< Updates about the performance of the server.
+	ADMIN_UPDATE_VEHICLES,        ///< Updates about the positions of the vehicles.
 	ADMIN_UPDATE_END,             ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -143,6 +149,7 @@ protected:
 	 * Register updates to be sent at certain frequencies (as announced in the PROTOCOL packet):
 	 * uint16_t  Update type (see #AdminUpdateType). Note integer type - see "Certain Packet Information" in docs/admin_network.md.
 	 * uint16_t  Update frequency (see #AdminUpdateFrequency), setting #ADMIN_FREQUENCY_POLL is always ignored.
+	 * uint32_t  Optional: for #ADMIN_UPDATE_STATIONS the company to limit the updates to, or UINT32_MAX for all companies.
 	 * @param p The packet that was just received.
 	 * @return The state the network should have.
 	 */
@@ -530,6 +537,51 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_PONG(Packet &p);
 
+	/**
+	 * The server gives the admin the stations that changed since the previous update.
+	 * For each station, until the end of the packet:
+	 * uint16_t  ID of the station.
+	 * bool      Whether the station was removed (or is no longer of interest); if so, nothing else follows for this station.
+	 * uint8_t   ID of the owner of the station.
+	 * uint8_t   Facilities of the station (see #StationFacility).
+	 * uint32_t  Tile of the station sign.
+	 * uint8_t   Number of cargoes with a rating at the station, followed by for each of them:
+	 *   uint8_t   ID of the cargo.
+	 *   uint32_t  Amount of cargo waiting.
+	 *   uint8_t   Rating of the cargo.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_STATIONS(Packet &p);
+
+	/**
+	 * The server gives the admin its performance measurements:
+	 * uint32_t  Rate of the game loop, in thousandths of ticks per second.
+	 * uint8_t   Number of performance elements, followed by for each of them:
+	 *   uint8_t   ID of the element (see #PerformanceElement).
+	 *   uint32_t  Average processing time in microseconds.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_PERFORMANCE(Packet &p);
+
+	/**
+	 * The server gives the admin the positions of the vehicles that moved since they were last sent.
+	 * Only the front of each vehicle is sent, and only a part of all vehicle IDs is looked at per update.
+	 * For each vehicle, until the end of the packet:
+	 * uint32_t  ID of the vehicle.
+	 * bool      Whether the vehicle was removed or hidden, e.g. in a depot; if so, nothing else follows for this vehicle.
+	 * uint8_t   Type of the vehicle (see #VehicleType).
+	 * uint8_t   ID of the owner of the vehicle.
+	 * int32_t   X coordinate in world coordinates.
+	 * int32_t   Y coordinate in world coordinates.
+	 * int32_t   Z coordinate in world coordinates.
+	 * uint8_t   Direction the vehicle is facing (see #Direction).
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_VEHICLES(Packet &p);
+
 	/**
 	 * Notify the admin connection that the rcon command has finished.
 	 * string The command as requested by the admin connection.
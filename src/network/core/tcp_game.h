@@ -100,6 +100,7 @@ enum PacketGameType : uint8_t {
 	/* Sending commands around. */
 	PACKET_CLIENT_COMMAND,               ///< Client executed a command and sends it to the server.
 	PACKET_SERVER_COMMAND,               ///< Server distributes a command to (all) the clients.
+	PACKET_SERVER_COMMANDS,              ///< Server distributes a batch of commands to (all) the clients.
 
 	/* Human communication! */
 	PACKET_CLIENT_CHAT,                  ///< Client said something that should be distributed.
@@ -347,6 +348,21 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_COMMAND(Packet &p);
 
+	/**
+	 * Sends a batch of DoCommands to the client. Each command starts with
+	 * flags telling which fields differ from the previous command in the
+	 * batch; the first command sends all of them:
+	 * uint8_t   Flags (see CommandBatchFlags).
+	 * uint32_t  Frame of execution (only when it differs).
+	 * uint8_t   ID of the company (only when it differs).
+	 * uint16_t  ID of the command (only when it differs).
+	 * uint16_t  Error message of the command (only when the command differs).
+	 * <var>   Command specific buffer with encoded parameters of variable length.
+	 * uint8_t   ID of the callback (only when there is a callback).
+	 * @param p The packet that was just received.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_COMMANDS(Packet &p);
+
 	/**
 	 * Sends a chat-packet to the server:
 	 * uint8_t   ID of the action (see NetworkAction).
@@ -521,6 +537,8 @@ public:
 
 	const char *ReceiveCommand(Packet &p, CommandPacket &cp);
 	void SendCommand(Packet &p, const CommandPacket &cp);
+	const char *ReceiveCommandInBatch(Packet &p, CommandPacket &cp, bool first);
+	bool SendCommandInBatch(Packet &p, const CommandPacket &cp, const CommandPacket *prev);
 
 	bool IsPendingDeletion() const { return this->is_pending_deletion; }
 
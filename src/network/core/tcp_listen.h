@@ -29,7 +29,59 @@ class TCPListenHandler {
 	/** List of sockets we listen on. */
 	static SocketList sockets;
 
+#ifdef HAVE_EPOLL
+	/** The epoll instance to wait for the listening and client sockets with, or -1 to use select. */
+	static int epoll_fd;
+
+	/**
+	 * Handle the receiving of packets, for the sockets that epoll says are ready.
+	 * Sockets are only waited for to become writable once sending to them would block.
+	 * @return true if everything went okay.
+	 */
+	static bool ReceiveEpoll()
+	{
+		static std::vector<epoll_event> ready;
+		ready.resize(Tsocket::GetNumItems() + sockets.size());
+		int count = epoll_wait(epoll_fd, ready.data(), static_cast<int>(ready.size()), 0); // don't block at all.
+		if (count < 0) return false;
+
+		bool accept = false;
+		for (const epoll_event &ev : std::span(ready.data(), count)) {
+			/* The listening sockets are registered without a client. */
+			if (ev.data.ptr == nullptr) {
+				accept = true;
+				continue;
+			}
+
+			Tsocket *cs = static_cast<Tsocket *>(static_cast<NetworkTCPSocketHandler *>(ev.data.ptr));
+			if ((ev.events & EPOLLOUT) != 0) {
+				cs->writable = true;
+				cs->UpdateEpollEvents();
+			}
+			if ((ev.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0) cs->ReceivePackets();
+		}
+
+		/* accept clients.. */
+		if (accept) {
+			for (auto &s : sockets) AcceptClient(s.first);
+		}
+
+		return _networking;
+	}
+#endif /* HAVE_EPOLL */
+
 public:
+	/**
+	 * Start waiting for a newly accepted client with epoll, when epoll is used.
+	 * @param cs The client to wait for.
+	 */
+	static void WatchClient([[maybe_unused]] Tsocket *cs)
+	{
+#ifdef HAVE_EPOLL
+		if (epoll_fd != -1) cs->WatchWithEpoll(epoll_fd);
+#endif
+	}
+
 	static bool ValidateClient(SOCKET s, NetworkAddress &address)
 	{
 		/* Check if the client is banned. */
@@ -100,6 +152,10 @@ public:
 	 */
 	static bool Receive()
 	{
+#ifdef HAVE_EPOLL
+		if (epoll_fd != -1) return ReceiveEpoll();
+#endif
+
 		fd_set read_fd, write_fd;
 		struct timeval tv;
 
@@ -157,6 +213,20 @@ public:
 			return false;
 		}
 
+#ifdef HAVE_EPOLL
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		for (auto &s : sockets) {
+			epoll_event ev{};
+			ev.events = EPOLLIN;
+			ev.data.ptr = nullptr;
+			if (epoll_fd != -1 && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, s.first, &ev) < 0) {
+				close(epoll_fd);
+				epoll_fd = -1;
+			}
+		}
+		if (epoll_fd == -1) Debug(net, 1, "[{}] Could not use epoll, falling back to select: {}", Tsocket::GetName(), NetworkError::GetLast().AsString());
+#endif
+
 		return true;
 	}
 
@@ -167,10 +237,24 @@ public:
 			closesocket(s.first);
 		}
 		sockets.clear();
+
+#ifdef HAVE_EPOLL
+		if (epoll_fd != -1) close(epoll_fd);
+		epoll_fd = -1;
+
+		/* Closing the epoll instance removed all sockets from it. */
+		for (Tsocket *cs : Tsocket::Iterate()) {
+			cs->epoll_events = 0;
+			cs->epoll_instance = -1;
+		}
+#endif
 		Debug(net, 5, "[{}] Closed listeners", Tsocket::GetName());
 	}
 };
 
 template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> SocketList TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::sockets;
+#ifdef HAVE_EPOLL
+template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> int TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::epoll_fd = -1;
+#endif
 
 #endif /* NETWORK_CORE_TCP_LISTEN_H */
@@ -572,6 +572,7 @@ NetworkAddress ParseConnectionString(const std::string &connection_string, uint1
 
 	ServerNetworkGameSocketHandler *cs = new ServerNetworkGameSocketHandler(s);
 	cs->client_address = address; // Save the IP of the client
+	WatchClient(cs);
 
 	InvalidateWindowData(WC_CLIENT_LIST, 0);
 }
@@ -1256,6 +1257,7 @@ void NetworkGameLoop()
 #ifdef NETWORK_SEND_DOUBLE_SEED
 		_sync_seed_2 = _random.state[1];
 #endif
+		_sync_state.valid = false;
 
 		NetworkServer_Tick(send_frame);
 	} else {
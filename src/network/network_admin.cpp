@@ -11,6 +11,8 @@
 #include "../strings_func.h"
 #include "../timer/timer_game_calendar.h"
 #include "../timer/timer_game_calendar.h"
+#include "../timer/timer.h"
+#include "../timer/timer_game_tick.h"
 #include "core/network_game_info.h"
 #include "network_admin.h"
 #include "network_base.h"
@@ -20,6 +22,9 @@
 #include "../console_func.h"
 #include "../core/pool_func.hpp"
 #include "../map_func.h"
+#include "../station_base.h"
+#include "../vehicle_base.h"
+#include "../framerate_type.h"
 #include "../rev.h"
 #include "../game/game.hpp"
 
@@ -44,6 +49,11 @@ static NetworkAuthenticationDefaultAuthorizedKeyHandler _admin_authorized_key_ha
 /** The timeout for authorisation of the client. */
 static const std::chrono::seconds ADMIN_AUTHORISATION_TIMEOUT(10);
 
+/** Number of vehicle IDs looked at in a single vehicle update, to bound the cost per admin. */
+static const uint ADMIN_MAX_VEHICLES_PER_UPDATE = 4096;
+/** Number of ticks between automatic vehicle updates. */
+static const uint ADMIN_VEHICLES_AUTOMATIC_INTERVAL = 4;
+
 
 /** Frequencies, which may be registered for a certain update type. */
 static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
@@ -57,6 +67,9 @@ static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
 	ADMIN_FREQUENCY_POLL,                                                                                                                                  ///< ADMIN_UPDATE_CMD_NAMES
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CMD_LOGGING
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_GAMESCRIPT
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_STATIONS
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_PERFORMANCE
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY |                                                                     ADMIN_FREQUENCY_AUTOMATIC,          ///< ADMIN_UPDATE_VEHICLES
 };
 /** Sanity check. */
 static_assert(lengthof(_admin_update_type_frequencies) == ADMIN_UPDATE_END);
@@ -125,6 +138,7 @@ ServerNetworkAdminSocketHandler::~ServerNetworkAdminSocketHandler()
 {
 	ServerNetworkAdminSocketHandler *as = new ServerNetworkAdminSocketHandler(s);
 	as->address = address; // Save the IP of the client
+	WatchClient(as);
 }
 
 /***********
@@ -445,6 +459,169 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCompanyStats()
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+static const uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325; ///< Start value of the FNV-1a hash of the state of a station.
+static const uint64_t FNV_PRIME = 0x100000001B3; ///< Multiplier of the FNV-1a hash of the state of a station.
+
+/**
+ * Send the stations that changed since they were last sent to this admin.
+ * Only stations of #station_owner are sent, if that is set. Stations that
+ * disappeared, or that are no longer of interest, are sent as removed.
+ * @param full Whether to send all stations, instead of only the changed ones.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendStations(bool full)
+{
+	if (full) this->sent_stations.clear();
+
+	std::unique_ptr<Packet> p;
+	/* Get a packet with enough space left, sending the previous one when it is full. */
+	auto get_packet = [this, &p](size_t size) -> Packet & {
+		if (p != nullptr && !p->CanWriteToPacket(size)) this->SendPacket(std::move(p));
+		if (p == nullptr) p = std::make_unique<Packet>(this, ADMIN_PACKET_SERVER_STATIONS);
+		return *p;
+	};
+
+	for (const Station *st : Station::Iterate()) {
+		if (this->station_owner != INVALID_OWNER && st->owner != this->station_owner) continue;
+
+		/* Only a hash of the sent state is kept, so nothing needs to be allocated per station. */
+		uint64_t hash = FNV_OFFSET_BASIS;
+		auto add_to_hash = [&hash](uint32_t value) { hash = (hash ^ value) * FNV_PRIME; };
+		add_to_hash(st->owner);
+		add_to_hash(st->facilities);
+		add_to_hash(st->xy.base());
+
+		uint8_t cargoes = 0;
+		for (CargoID c = 0; c < NUM_CARGO; c++) {
+			const GoodsEntry &ge = st->goods[c];
+			if (!ge.HasRating()) continue;
+			cargoes++;
+			add_to_hash(c);
+			add_to_hash(ge.HasData() ? ge.GetData().cargo.TotalCount() : 0);
+			add_to_hash(ge.rating);
+		}
+
+		auto [it, inserted] = this->sent_stations.try_emplace(st->index, hash);
+		if (!inserted) {
+			if (it->second == hash) continue;
+			it->second = hash;
+		}
+
+		Packet &packet = get_packet(sizeof(uint16_t) + sizeof(bool) + sizeof(uint8_t) * 3 + sizeof(uint32_t) + cargoes * (sizeof(uint8_t) * 2 + sizeof(uint32_t)));
+		packet.Send_uint16(st->index);
+		packet.Send_bool(false);
+		packet.Send_uint8(st->owner);
+		packet.Send_uint8(st->facilities);
+		packet.Send_uint32(st->xy.base());
+		packet.Send_uint8(cargoes);
+		for (CargoID c = 0; c < NUM_CARGO; c++) {
+			const GoodsEntry &ge = st->goods[c];
+			if (!ge.HasRating()) continue;
+			packet.Send_uint8(c);
+			packet.Send_uint32(ge.HasData() ? ge.GetData().cargo.TotalCount() : 0);
+			packet.Send_uint8(ge.rating);
+		}
+	}
+
+	for (auto it = this->sent_stations.begin(); it != this->sent_stations.end(); /* nothing */) {
+		const Station *st = Station::GetIfValid(it->first);
+		if (st != nullptr && (this->station_owner == INVALID_OWNER || st->owner == this->station_owner)) {
+			++it;
+			continue;
+		}
+
+		Packet &packet = get_packet(sizeof(uint16_t) + sizeof(bool));
+		packet.Send_uint16(it->first);
+		packet.Send_bool(true);
+		it = this->sent_stations.erase(it);
+	}
+
+	if (p != nullptr) this->SendPacket(std::move(p));
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/**
+ * Send the positions of the vehicles that moved since they were last sent to this admin.
+ * Only the front of each vehicle is sent; articulated parts, wagons and the shadows
+ * and rotors of aircraft are left out. Each update only looks at the next
+ * #ADMIN_MAX_VEHICLES_PER_UPDATE vehicle IDs, starting where the previous update
+ * stopped, so the cost of an update does not grow with the number of vehicles.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendVehicles()
+{
+	std::unique_ptr<Packet> p;
+	/* Get a packet with enough space left, sending the previous one when it is full. */
+	auto get_packet = [this, &p](size_t size) -> Packet & {
+		if (p != nullptr && !p->CanWriteToPacket(size)) this->SendPacket(std::move(p));
+		if (p == nullptr) p = std::make_unique<Packet>(this, ADMIN_PACKET_SERVER_VEHICLES);
+		return *p;
+	};
+
+	VehicleID first = this->next_vehicle;
+	VehicleID last = first + ADMIN_MAX_VEHICLES_PER_UPDATE; // One past the last vehicle ID of this update.
+	this->next_vehicle = 0;
+
+	/* The vehicles that moved. */
+	for (const Vehicle *v : Vehicle::Iterate(first)) {
+		if (v->index >= last) {
+			this->next_vehicle = last;
+			break;
+		}
+		if (!v->IsPrimaryVehicle() || (v->vehstatus & VS_HIDDEN)) continue;
+
+		std::array<int32_t, 6> state = { v->type, v->owner, v->x_pos, v->y_pos, v->z_pos, v->direction };
+		auto [it, inserted] = this->sent_vehicles.try_emplace(v->index, state);
+		if (!inserted && it->second == state) continue;
+		it->second = state;
+
+		Packet &packet = get_packet(sizeof(uint32_t) + sizeof(bool) + sizeof(uint8_t) * 3 + sizeof(int32_t) * 3);
+		packet.Send_uint32(v->index);
+		packet.Send_bool(false);
+		packet.Send_uint8(v->type);
+		packet.Send_uint8(v->owner);
+		packet.Send_uint32(v->x_pos);
+		packet.Send_uint32(v->y_pos);
+		packet.Send_uint32(v->z_pos);
+		packet.Send_uint8(v->direction);
+	}
+
+	/* The vehicles with IDs of this update that are gone. When the end of the vehicles was reached, that is all remaining IDs. */
+	auto end = this->next_vehicle == 0 ? this->sent_vehicles.end() : this->sent_vehicles.lower_bound(last);
+	for (auto it = this->sent_vehicles.lower_bound(first); it != end; /* nothing */) {
+		const Vehicle *v = Vehicle::GetIfValid(it->first);
+		if (v != nullptr && v->IsPrimaryVehicle() && !(v->vehstatus & VS_HIDDEN)) {
+			++it;
+			continue;
+		}
+
+		Packet &packet = get_packet(sizeof(uint32_t) + sizeof(bool));
+		packet.Send_uint32(it->first);
+		packet.Send_bool(true);
+		it = this->sent_vehicles.erase(it);
+	}
+
+	if (p != nullptr) this->SendPacket(std::move(p));
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/** Send the performance measurements of the server. */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendPerformance()
+{
+	auto p = std::make_unique<Packet>(this, ADMIN_PACKET_SERVER_PERFORMANCE);
+
+	p->Send_uint32(static_cast<uint32_t>(GetPerformanceRate(PFE_GAMELOOP) * 1000));
+	p->Send_uint8(PFE_MAX);
+	for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+		p->Send_uint8(e);
+		p->Send_uint32(static_cast<uint32_t>(GetPerformanceAverageDuration(e) * 1000));
+	}
+
+	this->SendPacket(std::move(p));
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /**
  * Send a chat message.
  * @param action The action associated with the message.
@@ -686,6 +863,11 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_UPDATE_FREQUENC
 
 	this->update_frequency[type] = freq;
 
+	if (type == ADMIN_UPDATE_STATIONS && p.CanReadFromPacket(sizeof(uint32_t))) {
+		uint32_t owner = p.Recv_uint32();
+		this->station_owner = owner == UINT32_MAX ? INVALID_OWNER : static_cast<Owner>(std::min<uint32_t>(owner, OWNER_NONE));
+	}
+
 	if (type == ADMIN_UPDATE_CONSOLE) DebugReconsiderSendRemoteMessages();
 
 	return NETWORK_RECV_STATUS_OKAY;
@@ -748,6 +930,22 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_POLL(Packet &p)
 			this->SendCmdNames();
 			break;
 
+		case ADMIN_UPDATE_STATIONS:
+			/* The admin is requesting all stations, optionally of a single company. */
+			this->station_owner = d1 == UINT32_MAX ? INVALID_OWNER : static_cast<Owner>(std::min<uint32_t>(d1, OWNER_NONE));
+			this->SendStations(true);
+			break;
+
+		case ADMIN_UPDATE_PERFORMANCE:
+			/* The admin is requesting the performance measurements. */
+			this->SendPerformance();
+			break;
+
+		case ADMIN_UPDATE_VEHICLES:
+			/* The admin is requesting the vehicles that moved. */
+			this->SendVehicles();
+			break;
+
 		default:
 			/* An unsupported "poll" update type. */
 			Debug(net, 1, "[admin] Not supported poll {} ({}) from '{}' ({}).", type, d1, this->admin_name, this->admin_version);
@@ -1068,6 +1266,17 @@ void ServerNetworkAdminSocketHandler::WelcomeAll()
 	}
 }
 
+/** Send the vehicles that moved to the admins that get them automatically, as vehicles move every tick. */
+static IntervalTimer<TimerGameTick> _network_admin_vehicles({ TimerGameTick::Priority::NONE, ADMIN_VEHICLES_AUTOMATIC_INTERVAL }, [](auto)
+{
+	if (!_network_server) return;
+
+	for (ServerNetworkAdminSocketHandler *as : ServerNetworkAdminSocketHandler::IterateActive()) {
+		/* Like the other periodic updates, do not pile them up for a slow admin. */
+		if ((as->update_frequency[ADMIN_UPDATE_VEHICLES] & ADMIN_FREQUENCY_AUTOMATIC) && !as->HasSendQueue()) as->SendVehicles();
+	}
+});
+
 /**
  * Send (push) updates to the admin network as they have registered for these updates.
  * @param freq the frequency to be processed.
@@ -1091,6 +1300,20 @@ void NetworkAdminUpdate(AdminUpdateFrequency freq)
 						as->SendCompanyStats();
 						break;
 
+					/* Do not pile up updates for an admin that cannot keep up with them.
+					 * The next update that is sent will contain all changes anyway. */
+					case ADMIN_UPDATE_STATIONS:
+						if (!as->HasSendQueue()) as->SendStations(false);
+						break;
+
+					case ADMIN_UPDATE_PERFORMANCE:
+						if (!as->HasSendQueue()) as->SendPerformance();
+						break;
+
+					case ADMIN_UPDATE_VEHICLES:
+						if (!as->HasSendQueue()) as->SendVehicles();
+						break;
+
 					default: NOT_REACHED();
 				}
 			}
@@ -13,6 +13,8 @@
 #include "network_internal.h"
 #include "core/tcp_listen.h"
 #include "core/tcp_admin.h"
+#include "../station_type.h"
+#include "../vehicle_type.h"
 
 extern AdminIndex _redirect_console_to_admin;
 
@@ -46,6 +48,10 @@ public:
 	AdminUpdateFrequency update_frequency[ADMIN_UPDATE_END]; ///< Admin requested update intervals.
 	std::chrono::steady_clock::time_point connect_time;      ///< Time of connection.
 	NetworkAddress address;                                  ///< Address of the admin.
+	Owner station_owner = INVALID_OWNER;                     ///< Owner to limit the station updates to, or #INVALID_OWNER for all stations.
+	std::map<StationID, uint64_t> sent_stations;             ///< Hash of the state of the stations as last sent to the admin.
+	std::map<VehicleID, std::array<int32_t, 6>> sent_vehicles; ///< Type, owner and position of the vehicles as last sent to the admin.
+	VehicleID next_vehicle = 0;                              ///< Vehicle to start the next vehicle update at.
 
 	ServerNetworkAdminSocketHandler(SOCKET s);
 	~ServerNetworkAdminSocketHandler();
@@ -67,6 +73,9 @@ public:
 	NetworkRecvStatus SendCompanyRemove(CompanyID company_id, AdminCompanyRemoveReason bcrr);
 	NetworkRecvStatus SendCompanyEconomy();
 	NetworkRecvStatus SendCompanyStats();
+	NetworkRecvStatus SendStations(bool full);
+	NetworkRecvStatus SendPerformance();
+	NetworkRecvStatus SendVehicles();
 
 	NetworkRecvStatus SendChat(NetworkAction action, DestType desttype, ClientID client_id, const std::string &msg, int64_t data);
 	NetworkRecvStatus SendRcon(uint16_t colour, const std::string_view command);
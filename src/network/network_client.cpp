@@ -32,6 +32,8 @@
 #include "../core/backup_type.hpp"
 #include "../thread.h"
 #include "../social_integration.h"
+#include <mutex>
+#include <condition_variable>
 
 #include "table/strings.h"
 
@@ -39,7 +41,12 @@
 
 /* This file handles all the client-commands */
 
-/** Read some packets, and when do use that data as initial load filter. */
+/**
+ * Read some packets, and when done use that data as initial load filter.
+ * While the packets are being received, the savegame is already decompressed
+ * on a separate thread, so only the loading itself remains once all packets
+ * have been received.
+ */
 struct PacketReader : LoadFilter {
 	static const size_t CHUNK = 32 * 1024;  ///< 32 KiB chunks of memory.
 
@@ -50,6 +57,50 @@ struct PacketReader : LoadFilter {
 	size_t written_bytes;                   ///< The total number of bytes we've written.
 	size_t read_bytes;                      ///< The total number of read bytes.
 
+	std::mutex mutex;                          ///< Mutex for adding packets while the savegame is being decompressed.
+	std::condition_variable data_added;        ///< Signal for the decompression that packets were added, or that no more will be.
+	bool finished = false;                     ///< Whether all packets have been received.
+	bool aborted = false;                      ///< Whether the savegame will not be loaded anymore.
+	std::thread decompress_thread;             ///< Thread decompressing the savegame while it is being received.
+	std::shared_ptr<PacketReader> decompressed; ///< The decompressed savegame, if decompressing it succeeded.
+
+	/** Reads the packets while they are being received, to decompress them. */
+	struct Stream : LoadFilter {
+		PacketReader &reader;                  ///< The reader the packets are added to.
+		size_t read_bytes = 0;                 ///< The total number of read bytes.
+
+		Stream(PacketReader &reader) : LoadFilter(nullptr), reader(reader) {}
+
+		size_t Read(uint8_t *rbuf, size_t size) override
+		{
+			std::unique_lock<std::mutex> lock(this->reader.mutex);
+			this->reader.data_added.wait(lock, [this, size]() { return this->reader.finished || this->reader.aborted || this->reader.written_bytes - this->read_bytes >= size; });
+			if (this->reader.aborted) return 0;
+
+			size = std::min(this->reader.written_bytes - this->read_bytes, size);
+			for (size_t done = 0; done != size;) {
+				size_t offset = this->read_bytes % CHUNK;
+				size_t to_read = std::min(CHUNK - offset, size - done);
+				memcpy(rbuf + done, this->reader.blocks[this->read_bytes / CHUNK] + offset, to_read);
+				done += to_read;
+				this->read_bytes += to_read;
+			}
+			return size;
+		}
+	};
+
+	/** Writes the decompressed savegame into another reader. */
+	struct Decompressed : SaveFilter {
+		PacketReader &reader;                  ///< The reader to write the decompressed savegame to.
+
+		Decompressed(PacketReader &reader) : SaveFilter(nullptr), reader(reader) {}
+
+		void Write(uint8_t *wbuf, size_t size) override
+		{
+			this->reader.Append(wbuf, size);
+		}
+	};
+
 	/** Initialise everything. */
 	PacketReader() : LoadFilter(nullptr), buf(nullptr), bufe(nullptr), block(nullptr), written_bytes(0), read_bytes(0)
 	{
@@ -57,6 +108,15 @@ struct PacketReader : LoadFilter {
 
 	~PacketReader() override
 	{
+		if (this->decompress_thread.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->aborted = true;
+			}
+			this->data_added.notify_one();
+			this->decompress_thread.join();
+		}
+
 		for (auto p : this->blocks) {
 			free(p);
 		}
@@ -84,16 +144,83 @@ struct PacketReader : LoadFilter {
 	void AddPacket(Packet &p)
 	{
 		assert(this->read_bytes == 0);
-		p.TransferOutWithLimit(TransferOutMemCopy, this->bufe - this->buf, this);
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			p.TransferOutWithLimit(TransferOutMemCopy, this->bufe - this->buf, this);
+
+			/* Did everything fit in the current chunk? If not, allocate a new chunk and add the remaining data. */
+			if (p.RemainingBytesToTransfer() != 0) {
+				this->blocks.push_back(this->buf = CallocT<uint8_t>(CHUNK));
+				this->bufe = this->buf + CHUNK;
+
+				p.TransferOutWithLimit(TransferOutMemCopy, this->bufe - this->buf, this);
+			}
+		}
+		this->data_added.notify_one();
+	}
+
+	/**
+	 * Add raw data to this buffer.
+	 * @param data The data to add.
+	 * @param size The number of bytes to add.
+	 */
+	void Append(const uint8_t *data, size_t size)
+	{
+		while (size != 0) {
+			if (this->buf == this->bufe) {
+				this->blocks.push_back(this->buf = CallocT<uint8_t>(CHUNK));
+				this->bufe = this->buf + CHUNK;
+			}
+
+			size_t to_write = std::min<size_t>(this->bufe - this->buf, size);
+			memcpy(this->buf, data, to_write);
+			this->buf += to_write;
+			this->written_bytes += to_write;
+			data += to_write;
+			size -= to_write;
+		}
+	}
 
-		/* Did everything fit in the current chunk, then we're done. */
-		if (p.RemainingBytesToTransfer() == 0) return;
+	/** Start decompressing the savegame while its packets are being received. */
+	void StartDecompressing()
+	{
+		StartNewThread(&this->decompress_thread, "ottd:decompress", [this]() {
+			auto decompressed = std::make_shared<PacketReader>();
+			Decompressed writer(*decompressed);
+			if (DecompressSavegame(std::make_shared<Stream>(*this), writer)) this->decompressed = decompressed;
+		});
+	}
 
-		/* Allocate a new chunk and add the remaining data. */
-		this->blocks.push_back(this->buf = CallocT<uint8_t>(CHUNK));
-		this->bufe = this->buf + CHUNK;
+	/**
+	 * Mark that all packets have been received, and get the decompressed savegame.
+	 * @return The decompressed savegame, or \c nullptr when the savegame has to be loaded as received.
+	 */
+	std::shared_ptr<PacketReader> FinishReceiving()
+	{
+		if (this->decompress_thread.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->finished = true;
+			}
+			this->data_added.notify_one();
+			this->decompress_thread.join();
+		}
 
-		p.TransferOutWithLimit(TransferOutMemCopy, this->bufe - this->buf, this);
+		if (this->decompressed != nullptr) {
+			Debug(net, 3, "Savegame of {} bytes was decompressed to {} bytes while being received", this->written_bytes, this->decompressed->written_bytes);
+
+			/* The received savegame is not needed anymore, so free its memory before loading. */
+			for (auto p : this->blocks) {
+				free(p);
+			}
+			this->blocks.clear();
+
+			this->decompressed->Reset();
+			return this->decompressed;
+		}
+
+		this->Reset();
+		return nullptr;
 	}
 
 	size_t Read(uint8_t *rbuf, size_t size) override
@@ -276,14 +403,26 @@ void ClientNetworkGameSocketHandler::ClientError(NetworkRecvStatus res)
 	/* Check if we are in sync! */
 	if (_sync_frame != 0) {
 		if (_sync_frame == _frame_counter) {
+			/* Compare the state hashes, so we can tell which part of the game state diverged. */
+			std::string diverged;
+			if (_sync_state.valid) {
+				NetworkSyncState state = NetworkCalculateSyncState(_sync_state.map_row);
+				for (uint8_t i = 0; i < SSC_END; i++) {
+					if (state.hashes[i] == _sync_state.hashes[i]) continue;
+					if (!diverged.empty()) diverged += ", ";
+					diverged += NetworkGetSyncStateComponentName(static_cast<SyncStateComponent>(i));
+				}
+			}
+
 #ifdef NETWORK_SEND_DOUBLE_SEED
-			if (_sync_seed_1 != _random.state[0] || _sync_seed_2 != _random.state[1]) {
+			if (_sync_seed_1 != _random.state[0] || _sync_seed_2 != _random.state[1] || !diverged.empty()) {
 #else
-			if (_sync_seed_1 != _random.state[0]) {
+			if (_sync_seed_1 != _random.state[0] || !diverged.empty()) {
 #endif
 				ShowNetworkError(STR_NETWORK_ERROR_DESYNC);
 				Debug(desync, 1, "sync_err: {:08x}; {:02x}", TimerGameEconomy::date, TimerGameEconomy::date_fract);
-				Debug(net, 0, "Sync error detected");
+				if (!diverged.empty()) Debug(desync, 1, "sync_err_state: {}; map rows {}-{}", diverged, _sync_state.map_row, _sync_state.map_row + NETWORK_SYNC_MAP_ROWS - 1);
+				Debug(net, 0, "Sync error detected{}{}", diverged.empty() ? "" : " in ", diverged);
 				my_client->ClientError(NETWORK_RECV_STATUS_DESYNC);
 				return false;
 			}
@@ -797,6 +936,7 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_BEGIN(Packe
 	if (this->savegame != nullptr) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
 
 	this->savegame = std::make_shared<PacketReader>();
+	this->savegame->StartDecompressing();
 
 	_frame_counter = _frame_counter_server = _frame_counter_max = p.Recv_uint32();
 
@@ -850,7 +990,8 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_DONE(Packet
 	_network_join_status = NETWORK_JOIN_STATUS_PROCESSING;
 	SetWindowDirty(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN);
 
-	this->savegame->Reset();
+	std::shared_ptr<LoadFilter> reader = this->savegame->FinishReceiving();
+	if (reader == nullptr) reader = this->savegame;
 
 	/* The map is done downloading, load it */
 	ClearErrorMessages();
@@ -858,7 +999,7 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_DONE(Packet
 	/* Set the abstract filetype. This is read during savegame load. */
 	_file_to_saveload.SetMode(SLO_LOAD, FT_SAVEGAME, DFT_GAME_FILE);
 
-	bool load_success = SafeLoad({}, SLO_LOAD, DFT_GAME_FILE, GM_NORMAL, NO_DIRECTORY, this->savegame);
+	bool load_success = SafeLoad({}, SLO_LOAD, DFT_GAME_FILE, GM_NORMAL, NO_DIRECTORY, reader);
 	this->savegame = nullptr;
 
 	/* Long savegame loads shouldn't affect the lag calculation! */
@@ -918,6 +1059,7 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_FRAME(Packet &p
 	if (p.CanReadFromPacket(sizeof(uint32_t))) {
 #endif
 		_sync_frame = _frame_counter_server;
+		_sync_state.valid = false;
 		_sync_seed_1 = p.Recv_uint32();
 #ifdef NETWORK_SEND_DOUBLE_SEED
 		_sync_seed_2 = p.Recv_uint32();
@@ -948,6 +1090,13 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_SYNC(Packet &p)
 	_sync_seed_2 = p.Recv_uint32();
 #endif
 
+	/* Servers only send the state hashes with their regular syncs. */
+	_sync_state.valid = p.CanReadFromPacket(sizeof(uint32_t) * (1 + SSC_END));
+	if (_sync_state.valid) {
+		_sync_state.map_row = p.Recv_uint32();
+		for (uint32_t &hash : _sync_state.hashes) hash = p.Recv_uint32();
+	}
+
 	Debug(net, 9, "Client::Receive_SERVER_SYNC(): sync_frame={}, sync_seed_1={}", _sync_frame, _sync_seed_1);
 
 	return NETWORK_RECV_STATUS_OKAY;
@@ -974,6 +1123,27 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_COMMAND(Packet
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_COMMANDS(Packet &p)
+{
+	if (this->status != STATUS_ACTIVE) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
+
+	/* Fields that are not in the packet are the same as for the previous command. */
+	CommandPacket cp;
+	for (bool first = true; p.CanReadFromPacket(sizeof(uint8_t)); first = false) {
+		const char *err = this->ReceiveCommandInBatch(p, cp, first);
+		if (err != nullptr) {
+			IConsolePrint(CC_WARNING, "Dropping server connection due to {}.", err);
+			return NETWORK_RECV_STATUS_MALFORMED_PACKET;
+		}
+
+		Debug(net, 9, "Client::Receive_SERVER_COMMANDS(): cmd={}, frame={}", cp.cmd, cp.frame);
+
+		this->incoming_queue.push_back(cp);
+	}
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_CHAT(Packet &p)
 {
 	if (this->status != STATUS_ACTIVE) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
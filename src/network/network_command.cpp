@@ -396,6 +396,83 @@ void NetworkGameSocketHandler::SendCommand(Packet &p, const CommandPacket &cp)
 	p.Send_uint8 ((uint8_t)callback);
 }
 
+/** Flags telling which fields of a command in a batch differ from the previous command. */
+enum CommandBatchFlags : uint8_t {
+	CBF_FRAME    = 1U << 0, ///< The frame of execution is sent.
+	CBF_COMPANY  = 1U << 1, ///< The company is sent.
+	CBF_COMMAND  = 1U << 2, ///< The command and its error message are sent.
+	CBF_CALLBACK = 1U << 3, ///< The callback is sent.
+	CBF_MY_CMD   = 1U << 4, ///< The command originated from the receiving client.
+};
+
+/**
+ * Receives a command from a batch of commands.
+ * @param p the packet to read from.
+ * @param cp the struct to write the data to; it must still contain the previous command of the batch.
+ * @param first whether this is the first command of the batch.
+ * @return an error message. When nullptr there has been no error.
+ */
+const char *NetworkGameSocketHandler::ReceiveCommandInBatch(Packet &p, CommandPacket &cp, bool first)
+{
+	uint8_t flags = p.Recv_uint8();
+	if (first && (flags & (CBF_FRAME | CBF_COMPANY | CBF_COMMAND)) != (CBF_FRAME | CBF_COMPANY | CBF_COMMAND)) return "incomplete command batch";
+
+	if (flags & CBF_FRAME) cp.frame = p.Recv_uint32();
+	if (flags & CBF_COMPANY) cp.company = (CompanyID)p.Recv_uint8();
+	if (flags & CBF_COMMAND) {
+		cp.cmd = static_cast<Commands>(p.Recv_uint16());
+		if (!IsValidCommand(cp.cmd))               return "invalid command";
+		if (GetCommandFlags(cp.cmd) & CMD_OFFLINE) return "single-player only command";
+		cp.err_msg = p.Recv_uint16();
+	}
+	cp.my_cmd = (flags & CBF_MY_CMD) != 0;
+	cp.data = _cmd_dispatch[cp.cmd].Sanitize(p.Recv_buffer());
+
+	uint8_t callback = (flags & CBF_CALLBACK) ? p.Recv_uint8() : 0;
+	if (callback >= _callback_table.size() || _cmd_dispatch[cp.cmd].Unpack[callback] == nullptr)  return "invalid callback";
+
+	cp.callback = _callback_table[callback];
+	return nullptr;
+}
+
+/**
+ * Sends a command as part of a batch of commands, only sending the
+ * fields that differ from the previous command in the batch.
+ * @param p the packet to send it in.
+ * @param cp the packet to actually send.
+ * @param prev the previous command in this batch, or nullptr for the first command.
+ * @return false when the command does not fit in the packet anymore; nothing is written then.
+ */
+bool NetworkGameSocketHandler::SendCommandInBatch(Packet &p, const CommandPacket &cp, const CommandPacket *prev)
+{
+	size_t callback = FindCallbackIndex(cp.callback);
+	if (callback > UINT8_MAX || _cmd_dispatch[cp.cmd].Unpack[callback] == nullptr) {
+		Debug(net, 0, "Unknown callback for command; no callback sent (command: {})", cp.cmd);
+		callback = 0; // _callback_table[0] == nullptr
+	}
+
+	uint8_t flags = 0;
+	if (prev == nullptr || prev->frame != cp.frame) flags |= CBF_FRAME;
+	if (prev == nullptr || prev->company != cp.company) flags |= CBF_COMPANY;
+	if (prev == nullptr || prev->cmd != cp.cmd || prev->err_msg != cp.err_msg) flags |= CBF_COMMAND;
+	if (callback != 0) flags |= CBF_CALLBACK;
+	if (cp.my_cmd) flags |= CBF_MY_CMD;
+
+	/* Flags, frame, company, command, error message, buffer size and callback at most. */
+	if (!p.CanWriteToPacket(sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint16_t) * 3 + sizeof(uint8_t) + cp.data.size())) return false;
+
+	p.Send_uint8(flags);
+	if (flags & CBF_FRAME) p.Send_uint32(cp.frame);
+	if (flags & CBF_COMPANY) p.Send_uint8(cp.company);
+	if (flags & CBF_COMMAND) {
+		p.Send_uint16(cp.cmd);
+		p.Send_uint16(cp.err_msg);
+	}
+	p.Send_buffer(cp.data);
+	if (flags & CBF_CALLBACK) p.Send_uint8((uint8_t)callback);
+	return true;
+}
+
 /** Helper to process a single ClientID argument. */
 template <class T>
 static inline void SetClientIdHelper(T &data, [[maybe_unused]] ClientID client_id)
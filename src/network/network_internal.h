@@ -66,6 +66,27 @@ extern uint32_t _sync_seed_1;
 extern uint32_t _sync_seed_2;
 #endif
 extern uint32_t _sync_frame;
+
+/** Parts of the game state that are hashed separately, so a desync can be traced to the part that diverged. */
+enum SyncStateComponent : uint8_t {
+	SSC_COMPANIES, ///< Money and loans of the companies.
+	SSC_VEHICLES,  ///< Positions and speeds of the vehicles.
+	SSC_STATIONS,  ///< Facilities and cargo ratings of the stations.
+	SSC_CARGO,     ///< Amounts of cargo in vehicles and at stations.
+	SSC_MAP,       ///< A stripe of rows of the map.
+	SSC_END,       ///< End marker.
+};
+
+static const uint32_t NETWORK_SYNC_MAP_ROWS = 16; ///< Number of map rows that are hashed at every sync.
+
+/** Hashes of the game state at a sync frame, sent along with the random seeds. */
+struct NetworkSyncState {
+	bool valid = false;                     ///< Whether the hashes belong to the current sync frame.
+	uint32_t map_row = 0;                   ///< First map row of the stripe hashed for #SSC_MAP.
+	std::array<uint32_t, SSC_END> hashes{}; ///< Hash of each part of the game state.
+};
+
+extern NetworkSyncState _sync_state;
 extern bool _network_first_time;
 /* Vars needed for the join-GUI */
 extern NetworkJoinStatus _network_join_status;
@@ -121,4 +142,7 @@ std::string NormalizeConnectionString(const std::string &connection_string, uint
 
 void ClientNetworkEmergencySave();
 
+NetworkSyncState NetworkCalculateSyncState(uint32_t map_row);
+std::string_view NetworkGetSyncStateComponentName(SyncStateComponent component);
+
 #endif /* NETWORK_INTERNAL_H */
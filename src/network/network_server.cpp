@@ -35,7 +35,6 @@
 #include "../timer/timer_game_economy.h"
 #include "../timer/timer_game_realtime.h"
 #include <mutex>
-#include <condition_variable>
 
 #include "../safeguards.h"
 
@@ -63,123 +62,95 @@ static NetworkAuthenticationDefaultAuthorizedKeyHandler _authorized_key_handler(
 static NetworkAuthenticationDefaultAuthorizedKeyHandler _rcon_authorized_key_handler(_settings_client.network.rcon_authorized_keys); ///< Provides the authorized key validation for rcon.
 
 
-/** Writing a savegame directly to a number of packets. */
-struct PacketWriter : SaveFilter {
-	ServerNetworkGameSocketHandler *cs; ///< Socket we are associated with.
-	std::unique_ptr<Packet> current; ///< The packet we're currently writing to.
-	size_t total_size;                  ///< Total size of the compressed savegame.
-	std::deque<std::unique_ptr<Packet>> packets; ///< Packet queue of the savegame; send these "slowly" to the client. Cannot be a std::queue as we want to push the map size packet in front of the data packets.
+/**
+ * A savegame that is made once, and sent to all clients that request the map in the
+ * same frame. As no commands are executed in between, they can all start from the same
+ * game state. The savegame is written by the (threaded) save, and read by the clients'
+ * packet writers at their own pace.
+ */
+struct MapSnapshot : SaveFilter {
+	uint32_t frame;                     ///< The frame this savegame was made in.
+	std::vector<uint8_t> data;          ///< The compressed savegame.
+	bool finished = false;              ///< Whether the savegame has been written completely.
 	std::mutex mutex;                   ///< Mutex for making threaded saving safe.
-	std::condition_variable exit_sig;   ///< Signal for threaded destruction of this packet writer.
 
 	/**
-	 * Create the packet writer.
-	 * @param cs The socket handler we're making the packets for.
+	 * Create the map snapshot.
+	 * @param frame The frame the savegame is made in.
 	 */
-	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(nullptr), cs(cs), total_size(0)
+	MapSnapshot(uint32_t frame) : SaveFilter(nullptr), frame(frame)
+	{
+	}
+
+	void Write(uint8_t *buf, size_t size) override
 	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->data.insert(this->data.end(), buf, buf + size);
 	}
 
-	/** Make sure everything is cleaned up. */
-	~PacketWriter()
+	void Finish() override
 	{
-		std::unique_lock<std::mutex> lock(this->mutex);
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->finished = true;
+	}
+};
 
-		if (this->cs != nullptr) this->exit_sig.wait(lock);
+/** The map snapshot that was made last, as long as any client is still using it. */
+static std::weak_ptr<MapSnapshot> _map_snapshot;
 
-		/* This must all wait until the Destroy function is called. */
+/** Writing a (shared) savegame to a number of packets for a client. */
+struct PacketWriter {
+	/** The amount of savegame data to queue for the client at once. */
+	static const size_t SEND_AHEAD = 1024 * 1024;
 
-		this->packets.clear();
-		this->current = nullptr;
-	}
+	ServerNetworkGameSocketHandler *cs; ///< Socket we are associated with.
+	std::shared_ptr<MapSnapshot> snapshot; ///< The savegame we are sending.
+	size_t sent_bytes = 0;              ///< The number of bytes of the savegame we have sent.
+	bool size_sent = false;             ///< Whether we have sent the size of the savegame.
 
 	/**
-	 * Begin the destruction of this packet writer. It can happen in two ways:
-	 * in the first case the client disconnected while saving the map. In this
-	 * case the saving has not finished and killed this PacketWriter. In that
-	 * case we simply set cs to nullptr, triggering the appending to fail due to
-	 * the connection problem and eventually triggering the destructor. In the
-	 * second case the destructor is already called, and it is waiting for our
-	 * signal which we will send. Only then the packets will be removed by the
-	 * destructor.
+	 * Create the packet writer.
+	 * @param cs The socket handler we're making the packets for.
+	 * @param snapshot The savegame to send.
 	 */
-	void Destroy()
+	PacketWriter(ServerNetworkGameSocketHandler *cs, std::shared_ptr<MapSnapshot> snapshot) : cs(cs), snapshot(snapshot)
 	{
-		std::unique_lock<std::mutex> lock(this->mutex);
-
-		this->cs = nullptr;
-
-		this->exit_sig.notify_all();
-		lock.unlock();
-
-		/* Make sure the saving is completely cancelled. Yes,
-		 * we need to handle the save finish as well as the
-		 * next connection might just be requesting a map. */
-		WaitTillSaved();
 	}
 
 	/**
-	 * Transfer all packets from here to the network's queue while holding
-	 * the lock on our mutex.
+	 * Transfer the next part of the savegame to the network's queue.
+	 * Only a limited amount is queued once the previous part has been sent,
+	 * so the savegame is not copied in full for every client.
 	 * @return True iff the last packet of the map has been sent.
 	 */
 	bool TransferToNetworkQueue()
 	{
-		/* Unsafe check for the queue being empty or not. */
-		if (this->packets.empty()) return false;
-
-		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->cs->HasSendQueue()) return false;
 
-		while (!this->packets.empty()) {
-			bool last_packet = this->packets.front()->GetPacketType() == PACKET_SERVER_MAP_DONE;
-			this->cs->SendPacket(std::move(this->packets.front()));
-			this->packets.pop_front();
+		std::lock_guard<std::mutex> lock(this->snapshot->mutex);
+		const std::vector<uint8_t> &data = this->snapshot->data;
 
-			if (last_packet) return true;
+		if (this->snapshot->finished && !this->size_sent) {
+			/* Fast-track the size to the client. */
+			auto p = std::make_unique<Packet>(this->cs, PACKET_SERVER_MAP_SIZE);
+			p->Send_uint32(static_cast<uint32_t>(data.size()));
+			this->cs->SendPacket(std::move(p));
+			this->size_sent = true;
 		}
 
-		return false;
-	}
-
-	void Write(uint8_t *buf, size_t size) override
-	{
-		std::lock_guard<std::mutex> lock(this->mutex);
-
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
-
-		if (this->current == nullptr) this->current = std::make_unique<Packet>(this->cs, PACKET_SERVER_MAP_DATA, TCP_MTU);
-
-		std::span<const uint8_t> to_write(buf, size);
-		while (!to_write.empty()) {
-			to_write = this->current->Send_bytes(to_write);
-
-			if (!this->current->CanWriteToPacket(1)) {
-				this->packets.push_back(std::move(this->current));
-				if (!to_write.empty()) this->current = std::make_unique<Packet>(this->cs, PACKET_SERVER_MAP_DATA, TCP_MTU);
-			}
+		size_t end = std::min(data.size(), this->sent_bytes + SEND_AHEAD);
+		while (this->sent_bytes != end) {
+			auto p = std::make_unique<Packet>(this->cs, PACKET_SERVER_MAP_DATA, TCP_MTU);
+			std::span<const uint8_t> to_write(data.data() + this->sent_bytes, end - this->sent_bytes);
+			this->sent_bytes += to_write.size() - p->Send_bytes(to_write).size();
+			this->cs->SendPacket(std::move(p));
 		}
 
-		this->total_size += size;
-	}
+		if (!this->snapshot->finished || this->sent_bytes != data.size()) return false;
 
-	void Finish() override
-	{
-		std::lock_guard<std::mutex> lock(this->mutex);
-
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
-
-		/* Make sure the last packet is flushed. */
-		if (this->current != nullptr) this->packets.push_back(std::move(this->current));
-
-		/* Add a packet stating that this is the end to the queue. */
-		this->packets.push_back(std::make_unique<Packet>(this->cs, PACKET_SERVER_MAP_DONE));
-
-		/* Fast-track the size to the client. */
-		auto p = std::make_unique<Packet>(this->cs, PACKET_SERVER_MAP_SIZE);
-		p->Send_uint32((uint32_t)this->total_size);
-		this->packets.push_front(std::move(p));
+		/* Add a packet stating that this is the end. */
+		this->cs->SendPacket(std::make_unique<Packet>(this->cs, PACKET_SERVER_MAP_DONE));
+		return true;
 	}
 };
 
@@ -212,10 +183,7 @@ ServerNetworkGameSocketHandler::~ServerNetworkGameSocketHandler()
 	if (_redirect_console_to_client == this->client_id) _redirect_console_to_client = INVALID_CLIENT_ID;
 	OrderBackup::ResetUser(this->client_id);
 
-	if (this->savegame != nullptr) {
-		this->savegame->Destroy();
-		this->savegame = nullptr;
-	}
+	this->savegame = nullptr;
 
 	InvalidateWindowData(WC_CLIENT_LIST, 0);
 }
@@ -259,11 +227,10 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::CloseConnection(NetworkRecvSta
 		}
 	}
 
-	/* If we were transfering a map to this client, stop the savegame creation
-	 * process and queue the next client to receive the map. */
+	/* If we were transfering a map to this client, stop that and queue the
+	 * next client to receive the map. The savegame might still be in use by
+	 * other clients, so it is not stopped. */
 	if (this->status == STATUS_MAP) {
-		/* Ensure the saving of the game is stopped too. */
-		this->savegame->Destroy();
 		this->savegame = nullptr;
 
 		this->CheckNextClientToSendMap(this);
@@ -526,27 +493,18 @@ void ServerNetworkGameSocketHandler::CheckNextClientToSendMap(NetworkClientSocke
 {
 	Debug(net, 9, "client[{}] CheckNextClientToSendMap()", this->client_id);
 
-	/* Find the best candidate for joining, i.e. the first joiner. */
-	NetworkClientSocket *best = nullptr;
+	/* Wait till everyone sharing the current savegame has it. */
 	for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
-		if (ignore_cs == new_cs) continue;
-
-		if (new_cs->status == STATUS_MAP_WAIT) {
-			if (best == nullptr || best->GetInfo()->join_date > new_cs->GetInfo()->join_date || (best->GetInfo()->join_date == new_cs->GetInfo()->join_date && best->client_id > new_cs->client_id)) {
-				best = new_cs;
-			}
-		}
+		if (ignore_cs != new_cs && new_cs->status == STATUS_MAP && new_cs->savegame != nullptr) return;
 	}
 
-	/* Is there someone else to join? */
-	if (best != nullptr) {
-		/* Let the first start joining. */
-		best->status = STATUS_AUTHORIZED;
-		best->SendMap();
+	/* Let everyone who is waiting start joining; they all share the same savegame. */
+	for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
+		if (ignore_cs == new_cs) continue;
 
-		/* And update the rest. */
-		for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
-			if (new_cs->status == STATUS_MAP_WAIT) new_cs->SendWait();
+		if (new_cs->status == STATUS_MAP_WAIT) {
+			new_cs->status = STATUS_AUTHORIZED;
+			new_cs->SendMap();
 		}
 	}
 }
@@ -562,8 +520,15 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 	if (this->status == STATUS_AUTHORIZED) {
 		Debug(net, 9, "client[{}] SendMap(): first_packet", this->client_id);
 
-		WaitTillSaved();
-		this->savegame = std::make_shared<PacketWriter>(this);
+		/* Clients requesting the map in the same frame share the savegame. */
+		std::shared_ptr<MapSnapshot> snapshot = _map_snapshot.lock();
+		bool new_snapshot = snapshot == nullptr || snapshot->frame != _frame_counter;
+		if (new_snapshot) {
+			WaitTillSaved();
+			snapshot = std::make_shared<MapSnapshot>(_frame_counter);
+			_map_snapshot = snapshot;
+		}
+		this->savegame = std::make_shared<PacketWriter>(this, snapshot);
 
 		/* Now send the _frame_counter and how many packets are coming */
 		auto p = std::make_unique<Packet>(this, PACKET_SERVER_MAP_BEGIN);
@@ -578,7 +543,7 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 		this->last_frame_server = _frame_counter;
 
 		/* Make a dump of the current game */
-		if (SaveWithFilter(this->savegame, true) != SL_OK) UserError("network savedump failed");
+		if (new_snapshot && SaveWithFilter(snapshot, true) != SL_OK) UserError("network savedump failed");
 	}
 
 	if (this->status == STATUS_MAP) {
@@ -586,8 +551,7 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 		if (last_packet) {
 			Debug(net, 9, "client[{}] SendMap(): last_packet", this->client_id);
 
-			/* Done reading, make sure saving is done as well */
-			this->savegame->Destroy();
+			/* Done reading; the savegame is freed once nobody uses it anymore. */
 			this->savegame = nullptr;
 
 			/* Set the status to DONE_MAP, no we will wait for the client
@@ -652,6 +616,12 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync()
 #ifdef NETWORK_SEND_DOUBLE_SEED
 	p->Send_uint32(_sync_seed_2);
 #endif
+
+	/* The state hashes are only known for the frames at which a sync is sent to everyone. */
+	if (_sync_state.valid) {
+		p->Send_uint32(_sync_state.map_row);
+		for (uint32_t hash : _sync_state.hashes) p->Send_uint32(hash);
+	}
 	this->SendPacket(std::move(p));
 	return NETWORK_RECV_STATUS_OKAY;
 }
@@ -674,6 +644,38 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendCommand(const CommandPacke
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Send all queued commands to the client, batching them into as few packets as possible.
+ * Commands of the same frame, company and type mostly only differ in their parameters,
+ * so only the fields that changed since the previous command of the batch are sent.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::SendCommands()
+{
+	std::unique_ptr<Packet> p;
+	const CommandPacket *prev = nullptr;
+	uint packets = 0;
+
+	for (const CommandPacket &cp : this->outgoing_queue) {
+		if (p != nullptr && !this->NetworkGameSocketHandler::SendCommandInBatch(*p, cp, prev)) {
+			this->SendPacket(std::move(p));
+			p = nullptr;
+		}
+
+		if (p == nullptr) {
+			p = std::make_unique<Packet>(this, PACKET_SERVER_COMMANDS, TCP_MTU);
+			packets++;
+			[[maybe_unused]] bool fits = this->NetworkGameSocketHandler::SendCommandInBatch(*p, cp, nullptr);
+			assert(fits);
+		}
+		prev = &cp;
+	}
+
+	Debug(net, 9, "client[{}] SendCommands(): commands={}, packets={}", this->client_id, this->outgoing_queue.size(), packets);
+
+	this->SendPacket(std::move(p));
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /**
  * Send a chat message.
  * @param action The action associated with the message.
@@ -995,9 +997,9 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_GETMAP(Packet &
 
 	Debug(net, 9, "client[{}] Receive_CLIENT_GETMAP()", this->client_id);
 
-	/* Check if someone else is receiving the map */
+	/* Check if someone else is receiving the map, and we cannot share their savegame */
 	for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
-		if (new_cs->status == STATUS_MAP) {
+		if (new_cs->status == STATUS_MAP && new_cs->savegame != nullptr && new_cs->savegame->snapshot->frame != _frame_counter) {
 			/* Tell the new client to wait */
 			Debug(net, 9, "client[{}] status = MAP_WAIT", this->client_id);
 			this->status = STATUS_MAP_WAIT;
@@ -1674,7 +1676,11 @@ bool NetworkServerChangeClientName(ClientID client_id, const std::string &new_na
  */
 static void NetworkHandleCommandQueue(NetworkClientSocket *cs)
 {
-	for (auto &cp : cs->outgoing_queue) cs->SendCommand(cp);
+	if (cs->outgoing_queue.size() == 1) {
+		cs->SendCommand(cs->outgoing_queue.front());
+	} else if (!cs->outgoing_queue.empty()) {
+		cs->SendCommands();
+	}
 	cs->outgoing_queue.clear();
 }
 
@@ -1692,6 +1698,12 @@ void NetworkServer_Tick(bool send_frame)
 	if (_frame_counter >= _last_sync_frame + _settings_client.network.sync_freq) {
 		_last_sync_frame = _frame_counter;
 		send_sync = true;
+
+		/* Walk through the map a stripe at a time, so every tile gets checked eventually. */
+		static uint32_t map_row = 0;
+		map_row %= Map::SizeY();
+		_sync_state = NetworkCalculateSyncState(map_row);
+		map_row += NETWORK_SYNC_MAP_ROWS;
 	}
 #endif
 
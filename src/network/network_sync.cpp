@@ -0,0 +1,132 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file network_sync.cpp Hashing of the game state to find out where a desync started. */
+
+#include "../stdafx.h"
+#include "network_internal.h"
+#include "../company_base.h"
+#include "../station_base.h"
+#include "../vehicle_base.h"
+#include "../map_func.h"
+
+#include "../safeguards.h"
+
+NetworkSyncState _sync_state; ///< Hashes of the game state at the sync frame.
+
+/**
+ * FNV-1a hash over integral values. The values are fed byte by byte
+ * from the least significant end, so the result does not depend on
+ * the endianness of the machine.
+ */
+struct SyncStateHasher {
+	uint32_t hash = 0x811C9DC5; ///< The hash so far.
+
+	/**
+	 * Add a value to the hash.
+	 * @param value The integral or enum value to add.
+	 */
+	template <typename T>
+	void Add(T value)
+	{
+		uint64_t v = static_cast<uint64_t>(value);
+		for (uint i = 0; i < sizeof(T); i++) {
+			this->hash = (this->hash ^ GB(v, i * 8, 8)) * 0x01000193;
+		}
+	}
+};
+
+/**
+ * Hash the parts of the game state that are most likely to diverge on a desync.
+ * Each part gets its own hash, so a client can tell which part differs from the server.
+ * Only a stripe of #NETWORK_SYNC_MAP_ROWS rows of the map is hashed, as
+ * hashing the whole map at every sync would be too expensive on large maps.
+ * @param map_row The first row of the map stripe to hash.
+ * @return The hashes of the current game state.
+ */
+NetworkSyncState NetworkCalculateSyncState(uint32_t map_row)
+{
+	SyncStateHasher companies, vehicles, stations, cargo, map;
+
+	for (const Company *c : Company::Iterate()) {
+		companies.Add(c->index);
+		companies.Add(static_cast<int64_t>(c->money));
+		companies.Add(static_cast<int64_t>(c->current_loan));
+	}
+
+	for (const Vehicle *v : Vehicle::Iterate()) {
+		vehicles.Add(v->index);
+		vehicles.Add(v->tile.base());
+		vehicles.Add(v->x_pos);
+		vehicles.Add(v->y_pos);
+		vehicles.Add(v->z_pos);
+		vehicles.Add(v->direction);
+		vehicles.Add(v->cur_speed);
+		vehicles.Add(v->progress);
+		vehicles.Add(v->vehstatus);
+
+		cargo.Add(v->index);
+		cargo.Add(v->cargo_type);
+		cargo.Add(v->cargo.StoredCount());
+	}
+
+	for (const Station *st : Station::Iterate()) {
+		stations.Add(st->index);
+		stations.Add(st->xy.base());
+		stations.Add(st->facilities);
+
+		for (const GoodsEntry &ge : st->goods) {
+			stations.Add(ge.rating);
+			stations.Add(ge.time_since_pickup);
+			if (ge.HasData()) cargo.Add(ge.GetData().cargo.TotalCount());
+		}
+	}
+
+	uint32_t last_row = std::min(map_row + NETWORK_SYNC_MAP_ROWS, Map::SizeY());
+	for (uint32_t y = map_row; y < last_row; y++) {
+		for (uint32_t x = 0; x < Map::SizeX(); x++) {
+			Tile t(TileXY(x, y));
+			map.Add(t.type());
+			map.Add(t.height());
+			map.Add(t.m1());
+			map.Add(t.m2());
+			map.Add(t.m3());
+			map.Add(t.m4());
+			map.Add(t.m5());
+			map.Add(t.m6());
+			map.Add(t.m7());
+			map.Add(t.m8());
+		}
+	}
+
+	NetworkSyncState state;
+	state.valid = true;
+	state.map_row = map_row;
+	state.hashes[SSC_COMPANIES] = companies.hash;
+	state.hashes[SSC_VEHICLES] = vehicles.hash;
+	state.hashes[SSC_STATIONS] = stations.hash;
+	state.hashes[SSC_CARGO] = cargo.hash;
+	state.hashes[SSC_MAP] = map.hash;
+	return state;
+}
+
+/**
+ * Get the name of a part of the game state, for the desync log.
+ * @param component The part of the game state.
+ * @return The name of the part.
+ */
+std::string_view NetworkGetSyncStateComponentName(SyncStateComponent component)
+{
+	switch (component) {
+		case SSC_COMPANIES: return "companies";
+		case SSC_VEHICLES: return "vehicles";
+		case SSC_STATIONS: return "stations";
+		case SSC_CARGO: return "cargo";
+		case SSC_MAP: return "map";
+		default: NOT_REACHED();
+	}
+}
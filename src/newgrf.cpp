@@ -51,6 +51,8 @@
 #include "vehicle_base.h"
 #include "road.h"
 #include "newgrf_roadstop.h"
+#include "spritecache.h"
+#include "thread.h"
 
 #include "table/strings.h"
 #include "table/build_industry.h"
@@ -94,8 +96,12 @@ private:
 		uint num_sprites; ///< Number of sprites in the set.
 	};
 
-	/** Currently referenceable spritesets */
-	std::map<uint, SpriteSet> spritesets[GSF_END];
+	/**
+	 * Currently referenceable spritesets. These are only defined in the activation
+	 * stage, which is never run on multiple threads, so they are shared by all
+	 * threads; that keeps the thread local state trivial to create and destroy.
+	 */
+	static inline std::map<uint, SpriteSet> spritesets[GSF_END];
 
 public:
 	/* Global state */
@@ -120,8 +126,10 @@ public:
 		this->nfo_line = 0;
 		this->skip_sprites = 0;
 
-		for (uint i = 0; i < GSF_END; i++) {
-			this->spritesets[i].clear();
+		if (this->stage == GLS_ACTIVATION) {
+			for (uint i = 0; i < GSF_END; i++) {
+				this->spritesets[i].clear();
+			}
 		}
 
 		memset(this->spritegroups, 0, sizeof(this->spritegroups));
@@ -195,7 +203,10 @@ public:
 	}
 };
 
-static GrfProcessingState _cur;
+/* Thread local, so GRFs can be scanned by multiple threads at once. Being
+ * trivially destructible, accessing it does not need to check for its construction. */
+static_assert(std::is_trivially_destructible_v<GrfProcessingState>);
+static thread_local GrfProcessingState _cur;
 
 
 /**
@@ -5352,6 +5363,8 @@ static void NewSpriteGroup(ByteReader &buf)
 				}
 			}
 
+			group->Optimise();
+
 			break;
 		}
 
@@ -8270,7 +8283,7 @@ static bool ChangeGRFMinVersion(size_t len, ByteReader &buf)
 	return true;
 }
 
-static GRFParameterInfo *_cur_parameter; ///< The parameter which info is currently changed by the newgrf.
+static thread_local GRFParameterInfo *_cur_parameter; ///< The parameter which info is currently changed by the newgrf.
 
 /** Callback function for 'INFO'->'PARAM'->param_num->'NAME' to set the name of a parameter. */
 static bool ChangeGRFParamName(uint8_t langid, std::string_view str)
@@ -8917,6 +8930,7 @@ void ResetNewGRFData()
 	InitializeSoundPool();
 	_spritegroup_pool.CleanPool();
 	_cached_callback_groups.clear();
+	ClearCallbackCache();
 }
 
 /**
@@ -9752,6 +9766,49 @@ static void LoadNewGRFFileFromFile(GRFConfig *config, GrfLoadingStage stage, Spr
 	}
 }
 
+/** A NewGRF of which the GOTO labels are to be scanned. */
+struct GRFLabelScan {
+	GRFConfig *config; ///< The configuration of the NewGRF.
+	GRFFile *grffile; ///< The NewGRF to add the labels to.
+	SpriteFile *file; ///< The opened file of the NewGRF.
+};
+
+/**
+ * Scan the GOTO labels of NewGRFs. In this stage only action 10 changes
+ * anything, namely the labels of the NewGRF that defines them, and all
+ * other actions are only skipped. So the NewGRFs are scanned on multiple
+ * threads, each with its own processing state.
+ * @param grfs The NewGRFs to scan, of which the files are opened already.
+ */
+static void ScanGotoLabels(const std::vector<GRFLabelScan> &grfs)
+{
+	std::atomic<size_t> next = 0;
+	auto worker = [&grfs, &next]() {
+		_cur.stage = GLS_LABELSCAN;
+		for (size_t i; (i = next++) < grfs.size(); ) {
+			_cur.grffile = grfs[i].grffile;
+			LoadNewGRFFileFromFile(grfs[i].config, GLS_LABELSCAN, *grfs[i].file);
+		}
+	};
+
+	/* A file that is loaded more than once must not be read by two threads at once. */
+	std::set<const SpriteFile *> files;
+	for (const GRFLabelScan &grf : grfs) files.insert(grf.file);
+
+	std::vector<std::thread> threads;
+	uint num_threads = files.size() == grfs.size() ? std::min<size_t>(std::thread::hardware_concurrency(), grfs.size()) : 1;
+	for (uint i = 1; i < num_threads; i++) {
+		std::thread &t = threads.emplace_back();
+		if (!StartNewThread(&t, "ottd:grflabels", [&worker]() { worker(); })) {
+			threads.pop_back();
+			break;
+		}
+	}
+
+	worker();
+	for (std::thread &t : threads) t.join();
+}
+
 /**
  * Load a particular NewGRF.
  * @param config     The configuration of the to be loaded NewGRF.
@@ -10157,6 +10214,7 @@ void LoadNewGRF(SpriteID load_index, uint num_baseset)
 
 		uint num_grfs = 0;
 		uint num_non_static = 0;
+		std::vector<GRFLabelScan> label_scans;
 
 		_cur.stage = stage;
 		for (GRFConfig *c = _grfconfig; c != nullptr; c = c->next) {
@@ -10184,6 +10242,12 @@ void LoadNewGRF(SpriteID load_index, uint num_baseset)
 
 			num_grfs++;
 
+			if (stage == GLS_LABELSCAN) {
+				/* The files are opened here, as the sprite file cache is not thread safe. */
+				label_scans.push_back({ c, _cur.grffile, &OpenCachedSpriteFile(c->filename, subdir, c->palette & GRFP_USE_MASK) });
+				continue;
+			}
+
 			LoadNewGRFFile(c, stage, subdir, false);
 			if (stage == GLS_RESERVE) {
 				SetBit(c->flags, GCF_RESERVED);
@@ -10198,6 +10262,8 @@ void LoadNewGRF(SpriteID load_index, uint num_baseset)
 				ClearTemporaryNewGRFData(_cur.grffile);
 			}
 		}
+
+		if (stage == GLS_LABELSCAN) ScanGotoLabels(label_scans);
 	}
 
 	/* Pseudo sprite processing is finished; free temporary stuff */
@@ -26,6 +26,10 @@
 
 #include "fileio_func.h"
 #include "fios.h"
+#include "ini_type.h"
+
+#include <atomic>
+#include <mutex>
 
 #include "safeguards.h"
 
@@ -260,14 +264,98 @@ size_t GRFGetSizeOfDataSection(FileHandle &f)
 	return SIZE_MAX;
 }
 
+std::string _newgrf_cache_file; ///< File with the cached MD5 sums of the NewGRFs.
+
+/** MD5 sum of a NewGRF, with the size and modification time of the file it was calculated for. */
+struct GRFMD5CacheEntry {
+	uintmax_t size; ///< Size of the file.
+	int64_t mtime;  ///< Modification time of the file.
+	MD5Hash md5sum; ///< MD5 sum of the data section of the file.
+	bool used;      ///< Whether the entry was used since the cache was loaded.
+};
+
+static std::map<std::string, GRFMD5CacheEntry> _grf_md5_cache; ///< Cached MD5 sums of NewGRFs, by full path.
+static std::mutex _grf_md5_cache_mutex; ///< Lock for #_grf_md5_cache, as the MD5 sums are calculated in parallel.
+static bool _grf_md5_cache_loaded = false; ///< Whether #_grf_md5_cache has been loaded from disk.
+
+/** Load the cached MD5 sums of the NewGRFs from disk, if that did not happen yet. */
+static void LoadGRFMD5Cache()
+{
+	if (_grf_md5_cache_loaded || _newgrf_cache_file.empty()) return;
+	_grf_md5_cache_loaded = true;
+
+	IniFile ini;
+	ini.LoadFromDisk(_newgrf_cache_file, NO_DIRECTORY);
+
+	const IniGroup *group = ini.GetGroup("md5");
+	if (group == nullptr) return;
+
+	for (const IniItem &item : group->items) {
+		if (!item.value.has_value()) continue;
+
+		/* Format is size,mtime,md5sum. */
+		GRFMD5CacheEntry entry{};
+		std::istringstream ss(*item.value);
+		std::string md5sum;
+		char sep1 = 0, sep2 = 0;
+		if (!(ss >> entry.size >> sep1 >> entry.mtime >> sep2 >> md5sum) || sep1 != ',' || sep2 != ',') continue;
+		if (!ConvertHexToBytes(md5sum, entry.md5sum)) continue;
+
+		_grf_md5_cache[item.name] = entry;
+	}
+}
+
+/** Save the cached MD5 sums of the NewGRFs that were used since loading them to disk. */
+static void SaveGRFMD5Cache()
+{
+	if (!_grf_md5_cache_loaded || _newgrf_cache_file.empty()) return;
+
+	IniFile ini;
+	IniGroup &group = ini.GetOrCreateGroup("md5");
+	for (auto it = _grf_md5_cache.begin(); it != _grf_md5_cache.end(); /* nothing */) {
+		if (!it->second.used) {
+			it = _grf_md5_cache.erase(it);
+			continue;
+		}
+		group.CreateItem(it->first).SetValue(fmt::format("{},{},{}", it->second.size, it->second.mtime, FormatArrayAsHex(it->second.md5sum)));
+		it->second.used = false;
+		++it;
+	}
+	ini.SaveToDisk(_newgrf_cache_file);
+}
+
 /**
  * Calculate the MD5 sum for a GRF, and store it in the config.
+ * When the file did not change since the MD5 sum was last calculated,
+ * the MD5 sum is taken from the cache instead.
  * @param config GRF to compute.
  * @param subdir The subdirectory to look in.
  * @return MD5 sum was successfully computed
  */
 static bool CalcGRFMD5Sum(GRFConfig *config, Subdirectory subdir)
 {
+	/* Only real files can be cached; NewGRFs inside tars have no modification time of their own. */
+	std::string path = FioFindFullPath(subdir, config->filename);
+	uintmax_t file_size = 0;
+	int64_t mtime = 0;
+	bool cacheable = !path.empty();
+	if (cacheable) {
+		std::error_code error_code;
+		file_size = std::filesystem::file_size(OTTD2FS(path), error_code);
+		if (!error_code) mtime = std::filesystem::last_write_time(OTTD2FS(path), error_code).time_since_epoch().count();
+		cacheable = !error_code;
+	}
+
+	if (cacheable) {
+		std::lock_guard<std::mutex> lock(_grf_md5_cache_mutex);
+		auto it = _grf_md5_cache.find(path);
+		if (it != _grf_md5_cache.end() && it->second.size == file_size && it->second.mtime == mtime) {
+			it->second.used = true;
+			config->ident.md5sum = it->second.md5sum;
+			return true;
+		}
+	}
+
 	Md5 checksum;
 	uint8_t buffer[1024];
 	size_t len, size;
@@ -290,18 +378,23 @@ static bool CalcGRFMD5Sum(GRFConfig *config, Subdirectory subdir)
 	}
 	checksum.Finish(config->ident.md5sum);
 
+	if (cacheable) {
+		std::lock_guard<std::mutex> lock(_grf_md5_cache_mutex);
+		_grf_md5_cache[path] = { file_size, mtime, config->ident.md5sum, true };
+	}
+
 	return true;
 }
 
 
 /**
- * Find the GRFID of a given grf, and calculate its md5sum.
+ * Find the GRFID of a given grf, without calculating its md5sum.
  * @param config    grf to fill.
  * @param is_static grf is static.
  * @param subdir    the subdirectory to search in.
  * @return Operation was successfully completed.
  */
-bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
+static bool ReadGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
 {
 	if (!FioCheckFileExists(config->filename, subdir)) {
 		config->status = GCS_NOT_FOUND;
@@ -324,7 +417,19 @@ bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
 		if (HasBit(config->flags, GCF_UNSAFE)) return false;
 	}
 
-	return CalcGRFMD5Sum(config, subdir);
+	return true;
+}
+
+/**
+ * Find the GRFID of a given grf, and calculate its md5sum.
+ * @param config    grf to fill.
+ * @param is_static grf is static.
+ * @param subdir    the subdirectory to search in.
+ * @return Operation was successfully completed.
+ */
+bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
+{
+	return ReadGRFDetails(config, is_static, subdir) && CalcGRFMD5Sum(config, subdir);
 }
 
 
@@ -506,14 +611,14 @@ int _skip_all_newgrf_scanning = 0;
 
 /** Helper for scanning for files with GRF as extension */
 class GRFFileScanner : FileScanner {
-	std::chrono::steady_clock::time_point next_update; ///< The next moment we do update the screen.
-	uint num_scanned; ///< The number of GRFs we have scanned.
+	std::atomic<uint> num_scanned; ///< The number of GRFs we have scanned.
+	std::vector<GRFConfig *> found; ///< The GRFs that were found, but of which the details are not known yet.
+
+	void ReadDetails();
+	bool AddToList(GRFConfig *c);
 
 public:
-	GRFFileScanner() : num_scanned(0)
-	{
-		this->next_update = std::chrono::steady_clock::now();
-	}
+	GRFFileScanner() : num_scanned(0) {}
 
 	bool AddFile(const std::string &filename, size_t basepath_length, const std::string &tar_filename) override;
 
@@ -525,8 +630,24 @@ public:
 			return 0;
 		}
 
+		LoadGRFMD5Cache();
+
 		GRFFileScanner fs;
-		int ret = fs.Scan(".grf", NEWGRF_DIR);
+		fs.Scan(".grf", NEWGRF_DIR);
+		fs.ReadDetails();
+
+		int ret = 0;
+		for (GRFConfig *c : fs.found) {
+			if (fs.AddToList(c)) {
+				ret++;
+			} else {
+				/* File couldn't be opened, or it's already known, so forget about it. */
+				delete c;
+			}
+		}
+
+		SaveGRFMD5Cache();
+
 		/* The number scanned and the number returned may not be the same;
 		 * duplicate NewGRFs and base sets are ignored in the return value. */
 		_settings_client.gui.last_newgrf_count = fs.num_scanned;
@@ -539,49 +660,85 @@ bool GRFFileScanner::AddFile(const std::string &filename, size_t basepath_length
 	/* Abort if the user stopped the game during a scan. */
 	if (_exit_game) return false;
 
-	GRFConfig *c = new GRFConfig(filename.c_str() + basepath_length);
+	/* The details are read afterwards, for all files at once. */
+	this->found.push_back(new GRFConfig(filename.c_str() + basepath_length));
+	return true;
+}
 
-	bool added = true;
-	if (FillGRFDetails(c, false)) {
-		if (_all_grfs == nullptr) {
-			_all_grfs = c;
-		} else {
-			/* Insert file into list at a position determined by its
-			 * name, so the list is sorted as we go along */
-			GRFConfig **pd, *d;
-			bool stop = false;
-			for (pd = &_all_grfs; (d = *pd) != nullptr; pd = &d->next) {
-				if (c->ident.grfid == d->ident.grfid && c->ident.md5sum == d->ident.md5sum) added = false;
-				/* Because there can be multiple grfs with the same name, make sure we checked all grfs with the same name,
-				 *  before inserting the entry. So insert a new grf at the end of all grfs with the same name, instead of
-				 *  just after the first with the same name. Avoids doubles in the list. */
-				if (StrCompareIgnoreCase(c->GetName(), d->GetName()) <= 0) {
-					stop = true;
-				} else if (stop) {
-					break;
-				}
-			}
-			if (added) {
-				c->next = d;
-				*pd = c;
-			}
+/**
+ * Read the details and calculate the MD5 sums of all found GRFs. The file
+ * and safety scans of a GRF do not depend on any other GRF, and the MD5 sum
+ * of files that are not in the MD5 cache requires reading the whole file,
+ * so this is spread over multiple threads. The results are merged in the
+ * order the files were found, so the outcome does not depend on the threads.
+ * GRFs that are not valid, or are 'system' NewGRFs, get a zero GRF ID.
+ */
+void GRFFileScanner::ReadDetails()
+{
+	std::atomic<size_t> next = 0;
+	auto worker = [this, &next](bool update_status) {
+		for (size_t i; !_exit_game && (i = next++) < this->found.size(); ) {
+			GRFConfig *c = this->found[i];
+			if (!FillGRFDetails(c, false, NEWGRF_DIR)) c->ident.grfid = 0;
+			this->num_scanned++;
+
+			/* Only the scanning thread itself may update the status window. */
+			if (!update_status) continue;
+
+			const char *name = nullptr;
+			if (c->name != nullptr) name = GetGRFStringFromGRFText(c->name);
+			if (name == nullptr) name = c->filename.c_str();
+			UpdateNewGRFScanStatus(this->num_scanned, name);
+			VideoDriver::GetInstance()->GameLoopPause();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	uint num_threads = std::min<size_t>(std::thread::hardware_concurrency(), this->found.size());
+	for (uint i = 1; i < num_threads; i++) {
+		std::thread &t = threads.emplace_back();
+		if (!StartNewThread(&t, "ottd:grfscan", [&worker]() { worker(false); })) {
+			threads.pop_back();
+			break;
 		}
-	} else {
-		added = false;
 	}
 
-	this->num_scanned++;
+	worker(true);
+	for (std::thread &t : threads) t.join();
+}
 
-	const char *name = nullptr;
-	if (c->name != nullptr) name = GetGRFStringFromGRFText(c->name);
-	if (name == nullptr) name = c->filename.c_str();
-	UpdateNewGRFScanStatus(this->num_scanned, name);
-	VideoDriver::GetInstance()->GameLoopPause();
+/**
+ * Add a GRF of which the details and MD5 sum are known to the list of all GRFs.
+ * @param c The GRF to add.
+ * @return Whether the GRF was added; it is not when it is invalid or a duplicate.
+ */
+bool GRFFileScanner::AddToList(GRFConfig *c)
+{
+	if (c->ident.grfid == 0) return false;
 
-	if (!added) {
-		/* File couldn't be opened, or is either not a NewGRF or is a
-		 * 'system' NewGRF or it's already known, so forget about it. */
-		delete c;
+	bool added = true;
+	if (_all_grfs == nullptr) {
+		_all_grfs = c;
+	} else {
+		/* Insert file into list at a position determined by its
+		 * name, so the list is sorted as we go along */
+		GRFConfig **pd, *d;
+		bool stop = false;
+		for (pd = &_all_grfs; (d = *pd) != nullptr; pd = &d->next) {
+			if (c->ident.grfid == d->ident.grfid && c->ident.md5sum == d->ident.md5sum) added = false;
+			/* Because there can be multiple grfs with the same name, make sure we checked all grfs with the same name,
+			 *  before inserting the entry. So insert a new grf at the end of all grfs with the same name, instead of
+			 *  just after the first with the same name. Avoids doubles in the list. */
+			if (StrCompareIgnoreCase(c->GetName(), d->GetName()) <= 0) {
+				stop = true;
+			} else if (stop) {
+				break;
+			}
+		}
+		if (added) {
+			c->next = d;
+			*pd = c;
+		}
 	}
 
 	return added;
@@ -608,9 +765,10 @@ void DoScanNewGRFFiles(NewGRFScanCallback *callback)
 	TarScanner::DoScan(TarScanner::NEWGRF);
 
 	Debug(grf, 1, "Scanning for NewGRFs");
+	auto start = std::chrono::steady_clock::now();
 	uint num = GRFFileScanner::DoScan();
 
-	Debug(grf, 1, "Scan complete, found {} files", num);
+	Debug(grf, 1, "Scan complete, found {} files in {} ms", num, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
 	if (num != 0 && _all_grfs != nullptr) {
 		/* Sort the linked list using quicksort.
 		 * For that we first have to make an array, then sort and
@@ -52,6 +52,8 @@ void NewGRFProfiler::BeginResolve(const ResolverObject &resolver)
 	this->cur_call.cb = resolver.callback;
 	this->cur_call.feat = resolver.GetFeature();
 	this->cur_call.item = resolver.GetDebugID();
+	this->cur_call.cache_hits = 0;
+	this->cur_call.cache_misses = 0;
 }
 
 /**
@@ -75,6 +77,19 @@ void NewGRFProfiler::EndResolve(const SpriteGroup *result)
 	this->calls.push_back(this->cur_call);
 }
 
+/**
+ * Capture a lookup in the callback cache during a sprite group resolution.
+ * @param hit Whether the result was found in the cache.
+ */
+void NewGRFProfiler::CacheLookup(bool hit)
+{
+	if (hit) {
+		this->cur_call.cache_hits++;
+	} else {
+		this->cur_call.cache_misses++;
+	}
+}
+
 /**
  * Capture a recursive sprite group resolution.
  */
@@ -104,6 +119,16 @@ uint32_t NewGRFProfiler::Finish()
 	std::string filename = this->GetOutputFilename();
 	IConsolePrint(CC_DEBUG, "Finished profile of NewGRF [{:08X}], writing {} events to '{}'.", BSWAP32(this->grffile->grfid), this->calls.size(), filename);
 
+	uint64_t cache_hits = 0;
+	uint64_t cache_misses = 0;
+	for (const Call &c : this->calls) {
+		cache_hits += c.cache_hits;
+		cache_misses += c.cache_misses;
+	}
+	if (cache_hits + cache_misses != 0) {
+		IConsolePrint(CC_DEBUG, "Callback cache: {} hits, {} misses, hit rate {}%.", cache_hits, cache_misses, cache_hits * 100 / (cache_hits + cache_misses));
+	}
+
 	uint32_t total_microseconds = 0;
 
 	auto f = FioFOpenFile(filename, "wt", Subdirectory::NO_DIRECTORY);
@@ -111,9 +136,9 @@ uint32_t NewGRFProfiler::Finish()
 	if (!f.has_value()) {
 		IConsolePrint(CC_ERROR, "Failed to open '{}' for writing.", filename);
 	} else {
-		fmt::print(*f, "Tick,Sprite,Feature,Item,CallbackID,Microseconds,Depth,Result\n");
+		fmt::print(*f, "Tick,Sprite,Feature,Item,CallbackID,Microseconds,Depth,Result,CacheHits,CacheMisses\n");
 		for (const Call &c : this->calls) {
-			fmt::print(*f, "{},{},{:#X},{},{:#X},{},{},{}\n", c.tick, c.root_sprite, c.feat, c.item, (uint)c.cb, c.time, c.subs, c.result);
+			fmt::print(*f, "{},{},{:#X},{},{:#X},{},{},{},{},{}\n", c.tick, c.root_sprite, c.feat, c.item, (uint)c.cb, c.time, c.subs, c.result, c.cache_hits, c.cache_misses);
 			total_microseconds += c.time;
 		}
 	}
@@ -27,6 +27,7 @@ struct NewGRFProfiler {
 	void BeginResolve(const ResolverObject &resolver);
 	void EndResolve(const SpriteGroup *result);
 	void RecursiveResolve();
+	void CacheLookup(bool hit);
 
 	void Start();
 	uint32_t Finish();
@@ -47,6 +48,8 @@ struct NewGRFProfiler {
 		uint64_t tick;         ///< Game tick
 		CallbackID cb;       ///< Callback ID
 		GrfSpecFeature feat; ///< GRF feature being resolved for
+		uint16_t cache_hits;   ///< Lookups in the callback cache that found the result
+		uint16_t cache_misses; ///< Lookups in the callback cache that did not find the result
 	};
 
 	const GRFFile *grffile;  ///< Which GRF is being profiled
@@ -137,10 +137,55 @@ static inline uint32_t GetVariable(const ResolverObject &object, ScopeResolver *
 	return &this->default_scope;
 }
 
+/** Everything the result of resolving a cacheable group depends on. */
+struct CallbackCacheKey {
+	const SpriteGroup *group; ///< The cacheable group that is resolved.
+	const GRFFile *grffile; ///< The NewGRF for the parameters.
+	CallbackID callback; ///< The callback.
+	uint32_t param1; ///< The first parameter of the callback.
+	uint32_t param2; ///< The second parameter of the callback.
+
+	bool operator==(const CallbackCacheKey &other) const = default;
+};
+
+/** Hash of a #CallbackCacheKey. */
+struct CallbackCacheKeyHash {
+	size_t operator()(const CallbackCacheKey &key) const
+	{
+		size_t hash = std::hash<const void *>{}(key.group) ^ std::hash<const void *>{}(key.grffile);
+		hash = hash * 31 + key.callback;
+		hash = hash * 31 + key.param1;
+		return hash * 31 + key.param2;
+	}
+};
+
+/** The outcome of resolving a cacheable group. */
+struct CallbackCacheEntry {
+	const SpriteGroup *result; ///< The group it resolved to.
+	uint16_t calculated_result; ///< The callback result, when #result is the group for calculated results.
+	uint32_t last_value; ///< The value of variable 0x1C after resolving.
+};
+
+/* Looking up a result in the cache costs about as much as resolving three or four adjustments. */
+static const uint RESOLVE_CALL_COST = 4; ///< Cost of resolving a subroutine or the group of a range, in adjustments.
+static const uint MIN_CACHED_RESOLVE_COST = 5; ///< Minimum cost of resolving a group before its results get cached, in adjustments.
+static const size_t MAX_CALLBACK_CACHE_SIZE = 1 << 16; ///< Number of results after which the cache is emptied, in case a parameter is rarely the same.
+static std::unordered_map<CallbackCacheKey, CallbackCacheEntry, CallbackCacheKeyHash> _callback_cache; ///< Results of groups that do not depend on the game state.
+static bool _resolving_cacheable_group = false; ///< Whether a cacheable group is being resolved, so groups within it need no caching of their own.
+static CallbackResultSpriteGroup _calculated_result_group(0); ///< Result of deterministic groups with a calculated result.
+
+/**
+ * Forget all cached callback results. To be called when the sprite groups are freed.
+ */
+void ClearCallbackCache()
+{
+	_callback_cache.clear();
+}
+
 /* Evaluate an adjustment for a variable of the given size.
  * U is the unsigned type and S is the signed type to use. */
 template <typename U, typename S>
-static U EvalAdjustT(const DeterministicSpriteGroupAdjust &adjust, ScopeResolver *scope, U last_value, uint32_t value)
+static uint32_t EvalAdjustOperandT(const DeterministicSpriteGroupAdjust &adjust, uint32_t value)
 {
 	value >>= adjust.shift_num;
 	value  &= adjust.and_mask;
@@ -151,6 +196,14 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust &adjust, ScopeResolver
 		case DSGA_TYPE_NONE: break;
 	}
 
+	return value;
+}
+
+template <typename U, typename S>
+static U EvalAdjustT(const DeterministicSpriteGroupAdjust &adjust, ScopeResolver *scope, U last_value, uint32_t value)
+{
+	value = EvalAdjustOperandT<U, S>(adjust, value);
+
 	switch (adjust.operation) {
 		case DSGA_OP_ADD:  return last_value + value;
 		case DSGA_OP_SUB:  return last_value - value;
@@ -180,12 +233,86 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust &adjust, ScopeResolver
 }
 
 
+/**
+ * Evaluate an adjustment for a variable of the size of a group.
+ * @param size The size of the variables of the group.
+ * @param adjust The adjustment to evaluate.
+ * @param scope The scope to store persistent values in.
+ * @param last_value The result of the previous adjustment.
+ * @param value The value of the variable of the adjustment.
+ * @return The result of the adjustment.
+ */
+static uint32_t EvalAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust, ScopeResolver *scope, uint32_t last_value, uint32_t value)
+{
+	switch (size) {
+		case DSG_SIZE_BYTE:  return EvalAdjustT<uint8_t,  int8_t> (adjust, scope, last_value, value);
+		case DSG_SIZE_WORD:  return EvalAdjustT<uint16_t, int16_t>(adjust, scope, last_value, value);
+		case DSG_SIZE_DWORD: return EvalAdjustT<uint32_t, int32_t>(adjust, scope, last_value, value);
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Evaluate the operand of an adjustment for a variable of the size of a group.
+ * @param size The size of the variables of the group.
+ * @param adjust The adjustment to evaluate.
+ * @param value The value of the variable of the adjustment.
+ * @return The operand the operation of the adjustment is applied with.
+ */
+static uint32_t EvalAdjustOperand(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust, uint32_t value)
+{
+	switch (size) {
+		case DSG_SIZE_BYTE:  return EvalAdjustOperandT<uint8_t,  int8_t> (adjust, value);
+		case DSG_SIZE_WORD:  return EvalAdjustOperandT<uint16_t, int16_t>(adjust, value);
+		case DSG_SIZE_DWORD: return EvalAdjustOperandT<uint32_t, int32_t>(adjust, value);
+		default: NOT_REACHED();
+	}
+}
+
 static bool RangeHighComparator(const DeterministicSpriteGroupRange &range, uint32_t value)
 {
 	return range.high < value;
 }
 
+/**
+ * Resolve the group. When the group does not depend on the state of the game,
+ * the outcome is looked up in or added to the cache of callback results.
+ * Groups within a cacheable group are not looked up themselves, so only the
+ * first cacheable group along the path that is taken gets cached.
+ * @param object Information needed to resolve the group.
+ * @return The resolved group.
+ */
 const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
+{
+	if (!this->cache_results || _resolving_cacheable_group) return this->ResolveUncached(object);
+
+	CallbackCacheKey key{ this, object.grffile, object.callback, object.callback_param1, object.callback_param2 };
+	auto it = _callback_cache.find(key);
+	auto profiler = std::ranges::find(_newgrf_profilers, object.grffile, &NewGRFProfiler::grffile);
+	if (profiler != _newgrf_profilers.end() && profiler->active) profiler->CacheLookup(it != _callback_cache.end());
+
+	if (it != _callback_cache.end()) {
+		const CallbackCacheEntry &entry = it->second;
+		object.last_value = entry.last_value;
+		if (entry.result == &_calculated_result_group) _calculated_result_group.result = entry.calculated_result;
+		return entry.result;
+	}
+
+	_resolving_cacheable_group = true;
+	const SpriteGroup *result = this->ResolveUncached(object);
+	_resolving_cacheable_group = false;
+
+	if (_callback_cache.size() >= MAX_CALLBACK_CACHE_SIZE) _callback_cache.clear();
+	_callback_cache.emplace(key, CallbackCacheEntry{ result, _calculated_result_group.result, object.last_value });
+	return result;
+}
+
+/**
+ * Resolve the group by evaluating its adjustments and ranges.
+ * @param object Information needed to resolve the group.
+ * @return The resolved group.
+ */
+const SpriteGroup *DeterministicSpriteGroup::ResolveUncached(ResolverObject &object) const
 {
 	uint32_t last_value = 0;
 	uint32_t value = 0;
@@ -195,7 +322,10 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 	for (const auto &adjust : this->adjusts) {
 		/* Try to get the variable. We shall assume it is available, unless told otherwise. */
 		bool available = true;
-		if (adjust.variable == 0x7E) {
+		if (adjust.variable == 0x1A) {
+			/* Constant, which does not need to go through all the global variables. */
+			value = UINT_MAX;
+		} else if (adjust.variable == 0x7E) {
 			const SpriteGroup *subgroup = SpriteGroup::Resolve(adjust.subroutine, object, false);
 			if (subgroup == nullptr) {
 				value = CALLBACK_FAILED;
@@ -216,12 +346,7 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 			return SpriteGroup::Resolve(this->error_group, object, false);
 		}
 
-		switch (this->size) {
-			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8_t,  int8_t> (adjust, scope, last_value, value); break;
-			case DSG_SIZE_WORD:  value = EvalAdjustT<uint16_t, int16_t>(adjust, scope, last_value, value); break;
-			case DSG_SIZE_DWORD: value = EvalAdjustT<uint32_t, int32_t>(adjust, scope, last_value, value); break;
-			default: NOT_REACHED();
-		}
+		value = EvalAdjust(this->size, adjust, scope, last_value, value);
 		last_value = value;
 	}
 
@@ -230,9 +355,14 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 	if (this->calculated_result) {
 		/* nvar == 0 is a special case -- we turn our value into a callback result */
 		if (value != CALLBACK_FAILED) value = GB(value, 0, 15);
-		static CallbackResultSpriteGroup nvarzero(0);
-		nvarzero.result = value;
-		return &nvarzero;
+		_calculated_result_group.result = value;
+		return &_calculated_result_group;
+	}
+
+	if (!this->range_table.empty()) {
+		uint32_t index = value - this->range_table_base;
+		uint range = index < this->range_table.size() ? this->range_table[index] : this->ranges.size();
+		return SpriteGroup::Resolve(range < this->ranges.size() ? this->ranges[range].group : this->default_group, object, false);
 	}
 
 	if (this->ranges.size() > 4) {
@@ -252,6 +382,181 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 	return SpriteGroup::Resolve(this->default_group, object, false);
 }
 
+/**
+ * Check whether a variable only depends on the callback that is being resolved,
+ * or is constant once the NewGRFs are loaded.
+ * @param variable The variable to check.
+ * @return True iff the variable does not depend on the state of the game.
+ */
+static bool IsCallbackInput(uint8_t variable)
+{
+	switch (variable) {
+		case 0x0C: // Callback
+		case 0x10: // Callback parameter 1
+		case 0x18: // Callback parameter 2
+		case 0x1A: // Constant
+		case 0x7F: // NewGRF parameter
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Check whether resolving a group only depends on the callback that is being resolved.
+ * @param group The group to check.
+ * @return True iff the result of resolving the group may be cached.
+ */
+static bool IsCacheableResult(const SpriteGroup *group)
+{
+	if (group == nullptr) return true;
+
+	switch (group->type) {
+		case SGT_DETERMINISTIC: return static_cast<const DeterministicSpriteGroup *>(group)->cacheable;
+		case SGT_REAL: // Depends on the loading state of the object.
+		case SGT_RANDOMIZED: return false;
+		default: return true;
+	}
+}
+
+/**
+ * Estimate the cost of resolving a group as part of another group.
+ * @param group The group to resolve.
+ * @return The cost, in adjustments.
+ */
+static uint GetResolveCost(const SpriteGroup *group)
+{
+	if (group == nullptr || group->type != SGT_DETERMINISTIC) return 0;
+	return RESOLVE_CALL_COST + static_cast<const DeterministicSpriteGroup *>(group)->resolve_cost;
+}
+
+/**
+ * Fold an adjustment with a constant into the adjustment before it, when the result stays the same.
+ * Both adjustments must have the operands of their constants computed already.
+ * @param prev The adjustment before the constant; it gets the folded result.
+ * @param next The adjustment that might be folded.
+ * @param prev_is_first Whether \a prev is the first adjustment of the group, so it operates on zero.
+ * @return True iff \a next is folded into \a prev, and can be removed.
+ */
+static bool FoldConstantAdjust(DeterministicSpriteGroupAdjust &prev, const DeterministicSpriteGroupAdjust &next, bool prev_is_first)
+{
+	if (next.variable != 0x1A) return false;
+	uint32_t constant = next.and_mask;
+
+	if (prev.variable == 0x1A) {
+		/* Two constants in a row with operations that can be combined. Results are only
+		 * truncated to the size of the group, so the combined constant may overflow. */
+		auto signed_constant = [](const DeterministicSpriteGroupAdjust &adjust) -> std::optional<uint32_t> {
+			if (adjust.operation == DSGA_OP_ADD) return adjust.and_mask;
+			if (adjust.operation == DSGA_OP_SUB) return 0 - adjust.and_mask;
+			return std::nullopt;
+		};
+		auto prev_sum = signed_constant(prev);
+		auto next_sum = signed_constant(next);
+		if (prev_sum.has_value() && next_sum.has_value()) {
+			prev.operation = DSGA_OP_ADD;
+			prev.and_mask = *prev_sum + *next_sum;
+			return true;
+		}
+
+		if (prev.operation != next.operation) return false;
+		switch (next.operation) {
+			case DSGA_OP_AND: prev.and_mask &= constant; return true;
+			case DSGA_OP_OR:  prev.and_mask |= constant; return true;
+			case DSGA_OP_XOR: prev.and_mask ^= constant; return true;
+			case DSGA_OP_MUL: prev.and_mask *= constant; return true;
+			default: return false;
+		}
+	}
+
+	/* A variable masked with a constant, i.e. "var & mask", masks the variable itself. */
+	bool result_is_operand = prev.operation == DSGA_OP_RST || (prev_is_first && prev.operation == DSGA_OP_ADD);
+	if (result_is_operand && prev.type == DSGA_TYPE_NONE && next.operation == DSGA_OP_AND) {
+		prev.and_mask &= constant;
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Prepare the group for resolving it quickly, once all its adjustments and ranges are known.
+ * The operands of constants are computed once, constants are folded into the adjustment
+ * before them where possible, and adjustments of constants at the start of the chain are
+ * folded into a single constant. Ranges that lie close together get a lookup table
+ * instead of a search. Groups that do not depend on the state of the game, and that are
+ * costly enough to resolve, are marked so their results get cached. The results of
+ * resolving the group are the same as without this.
+ */
+void DeterministicSpriteGroup::Optimise()
+{
+	/* Variable 0x1A is all bits set, so masking it with the operand gives the operand. */
+	for (DeterministicSpriteGroupAdjust &adjust : this->adjusts) {
+		if (adjust.variable != 0x1A) continue;
+		adjust.and_mask = EvalAdjustOperand(this->size, adjust, UINT_MAX);
+		adjust.type = DSGA_TYPE_NONE;
+		adjust.shift_num = 0;
+		adjust.add_val = 0;
+		adjust.divmod_val = 0;
+	}
+
+	/* Only storing has side effects, everything else with constants can be done right now. */
+	auto is_constant = [](const DeterministicSpriteGroupAdjust &adjust) {
+		return adjust.variable == 0x1A && adjust.operation != DSGA_OP_STO && adjust.operation != DSGA_OP_STOP;
+	};
+	auto last_constant = std::find_if_not(this->adjusts.begin(), this->adjusts.end(), is_constant);
+	if (last_constant != this->adjusts.begin()) {
+		uint32_t value = 0;
+		for (auto it = this->adjusts.begin(); it != last_constant; ++it) {
+			value = EvalAdjust(this->size, *it, nullptr, value, UINT_MAX);
+		}
+
+		DeterministicSpriteGroupAdjust &adjust = this->adjusts.front();
+		adjust.operation = DSGA_OP_ADD;
+		adjust.and_mask = value;
+		this->adjusts.erase(this->adjusts.begin() + 1, last_constant);
+	}
+
+	for (size_t i = 1; i < this->adjusts.size(); /* nothing */) {
+		if (FoldConstantAdjust(this->adjusts[i - 1], this->adjusts[i], i == 1)) {
+			this->adjusts.erase(this->adjusts.begin() + i);
+		} else {
+			i++;
+		}
+	}
+
+	this->cacheable = std::ranges::all_of(this->adjusts, [](const DeterministicSpriteGroupAdjust &adjust) {
+		if (adjust.operation == DSGA_OP_STO || adjust.operation == DSGA_OP_STOP) return false;
+		if (adjust.variable == 0x7E) return IsCacheableResult(adjust.subroutine);
+		return IsCallbackInput(adjust.variable == 0x7B ? adjust.parameter : adjust.variable);
+	}) && IsCacheableResult(this->default_group) && std::ranges::all_of(this->ranges, [](const DeterministicSpriteGroupRange &range) {
+		return IsCacheableResult(range.group);
+	});
+
+	/* Only results that are costly to resolve are worth looking up in the cache. The
+	 * cost of the group that is resolved to is the cost of the most costly one. */
+	this->resolve_cost = static_cast<uint>(this->adjusts.size());
+	for (const DeterministicSpriteGroupAdjust &adjust : this->adjusts) {
+		if (adjust.variable == 0x7E) this->resolve_cost += GetResolveCost(adjust.subroutine);
+	}
+	uint result_cost = GetResolveCost(this->default_group);
+	for (const DeterministicSpriteGroupRange &range : this->ranges) result_cost = std::max(result_cost, GetResolveCost(range.group));
+	this->resolve_cost += result_cost;
+	this->cache_results = this->cacheable && this->resolve_cost >= MIN_CACHED_RESOLVE_COST;
+
+	if (this->ranges.size() > 4) {
+		uint64_t span = static_cast<uint64_t>(this->ranges.back().high) - this->ranges.front().low + 1;
+		if (span <= MAX_RANGE_TABLE_SIZE) {
+			this->range_table_base = this->ranges.front().low;
+			this->range_table.assign(span, static_cast<uint16_t>(this->ranges.size()));
+			for (uint16_t i = 0; i < this->ranges.size(); i++) {
+				const DeterministicSpriteGroupRange &range = this->ranges[i];
+				std::fill(this->range_table.begin() + (range.low - this->range_table_base), this->range_table.begin() + (range.high - this->range_table_base + 1), i);
+			}
+		}
+	}
+}
 
 const SpriteGroup *RandomizedSpriteGroup::Resolve(ResolverObject &object) const
 {
@@ -178,8 +178,21 @@ struct DeterministicSpriteGroup : SpriteGroup {
 
 	const SpriteGroup *error_group; // was first range, before sorting ranges
 
+	static constexpr uint MAX_RANGE_TABLE_SIZE = 256; ///< Maximum number of values in #range_table.
+
+	std::vector<uint16_t> range_table; ///< Index into #ranges for each value from #range_table_base onwards, or the number of ranges for the default group; only when the ranges are dense enough.
+	uint32_t range_table_base = 0; ///< Value of the first entry of #range_table.
+	bool cacheable = false; ///< Whether resolving only depends on the callback and its parameters, so the result can be cached.
+	bool cache_results = false; ///< Whether the group is cacheable and resolving it costs more than looking up its result.
+	uint resolve_cost = 0; ///< Estimated cost of resolving the group, in adjustments; see #GetResolveCost.
+
+	void Optimise();
+
 protected:
 	const SpriteGroup *Resolve(ResolverObject &object) const override;
+
+private:
+	const SpriteGroup *ResolveUncached(ResolverObject &object) const;
 };
 
 enum RandomizedSpriteGroupCompareMode : uint8_t {
@@ -394,4 +407,6 @@ struct ResolverObject {
 	virtual uint32_t GetDebugID() const { return 0; }
 };
 
+void ClearCallbackCache();
+
 #endif /* NEWGRF_SPRITEGROUP_H */
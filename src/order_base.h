@@ -270,6 +270,17 @@ private:
 	TimerGameTick::Ticks timetable_duration;         ///< NOSAVE: Total timetabled duration of the order list.
 	TimerGameTick::Ticks total_duration;             ///< NOSAVE: Total (timetabled or not) duration of the order list.
 
+public:
+	/** Links the link refresher predicted for vehicles starting at a given order, see LinkRefresher::Run. */
+	struct PredictedLinks {
+		const Order *first; ///< Order the prediction started at.
+		bool has_cargo;     ///< Whether the vehicle could be carrying cargo when starting at \c first.
+		std::vector<std::pair<const Order *, const Order *>> links; ///< Pairs of stops whose links are refreshed, in the order they were refreshed.
+	};
+
+private:
+	std::vector<PredictedLinks> predicted_links;     ///< NOSAVE: Cached link predictions, only valid as long as the orders don't change.
+
 public:
 	/** Default constructor producing an invalid order list. */
 	OrderList(VehicleOrderID num_orders = INVALID_VEH_ORDER_ID)
@@ -393,6 +404,27 @@ public:
 
 	void FreeChain(bool keep_orderlist = false);
 
+	/**
+	 * Get the links predicted for a vehicle starting at the given order.
+	 * @param first Order the prediction starts at.
+	 * @param has_cargo Whether the vehicle may be carrying cargo.
+	 * @return The predicted links or nullptr if there are none cached.
+	 */
+	inline const PredictedLinks *GetPredictedLinks(const Order *first, bool has_cargo) const
+	{
+		auto it = std::ranges::find_if(this->predicted_links, [&](const PredictedLinks &p) { return p.first == first && p.has_cargo == has_cargo; });
+		return it == this->predicted_links.end() ? nullptr : &*it;
+	}
+
+	/**
+	 * Cache the links predicted for a vehicle.
+	 * @param links Predicted links.
+	 */
+	inline void AddPredictedLinks(PredictedLinks &&links) { this->predicted_links.push_back(std::move(links)); }
+
+	/** Drop all cached link predictions, as the orders have changed. */
+	inline void InvalidatePredictedLinks() { this->predicted_links.clear(); }
+
 	void DebugCheckSanity() const;
 };
 
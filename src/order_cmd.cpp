@@ -234,6 +234,9 @@ uint16_t Order::MapOldOrder() const
  */
 void InvalidateVehicleOrder(const Vehicle *v, int data)
 {
+	/* Orders may have been modified in place, so the link predictions are stale. */
+	if (v->orders != nullptr) v->orders->InvalidatePredictedLinks();
+
 	SetWindowDirty(WC_VEHICLE_VIEW, v->index);
 
 	if (data != 0) {
@@ -276,6 +279,7 @@ void OrderList::Initialize(Order *chain, Vehicle *v)
 {
 	this->first = chain;
 	this->first_shared = v;
+	this->predicted_links.clear();
 
 	this->num_orders = 0;
 	this->num_manual_orders = 0;
@@ -317,6 +321,8 @@ void OrderList::RecalculateTimetableDuration()
  */
 void OrderList::FreeChain(bool keep_orderlist)
 {
+	this->InvalidatePredictedLinks();
+
 	Order *next;
 	for (Order *o = this->first; o != nullptr; o = next) {
 		next = o->next;
@@ -455,6 +461,8 @@ StationIDStack OrderList::GetNextStoppingStation(const Vehicle *v, const Order *
  */
 void OrderList::InsertOrderAt(Order *new_order, int index)
 {
+	this->InvalidatePredictedLinks();
+
 	if (this->first == nullptr) {
 		this->first = new_order;
 	} else {
@@ -495,6 +503,8 @@ void OrderList::DeleteOrderAt(int index)
 {
 	if (index >= this->num_orders) return;
 
+	this->InvalidatePredictedLinks();
+
 	Order *to_remove;
 
 	if (index == 0) {
@@ -521,6 +531,8 @@ void OrderList::MoveOrder(int from, int to)
 {
 	if (from >= this->num_orders || to >= this->num_orders || from == to) return;
 
+	this->InvalidatePredictedLinks();
+
 	Order *moving_one;
 
 	/* Take the moving order out of the pointer-chain */
@@ -15,6 +15,12 @@
 #include "fileio_func.h"
 #include "string_func.h"
 
+#if defined(UNIX) && !defined(__EMSCRIPTEN__)
+#	include <sys/mman.h>
+#	include <unistd.h>
+#	define HAVE_MMAP
+#endif
+
 #include "safeguards.h"
 
 /**
@@ -42,9 +48,41 @@ RandomAccessFile::RandomAccessFile(const std::string &filename, Subdirectory sub
 	this->simplified_filename = name_without_path.substr(0, name_without_path.rfind('.'));
 	strtolower(this->simplified_filename);
 
+	this->MapFile();
 	this->SeekTo(static_cast<size_t>(pos), SEEK_SET);
 }
 
+RandomAccessFile::~RandomAccessFile()
+{
+#ifdef HAVE_MMAP
+	if (this->mapping != nullptr) munmap(this->mapping, this->mapping_size);
+#endif
+}
+
+/**
+ * Try to map the file into memory, so reading from it does not need any system calls.
+ * The buffer pointers then point directly into the mapping. When mapping fails, the
+ * file is read through the file handle instead.
+ */
+void RandomAccessFile::MapFile()
+{
+#ifdef HAVE_MMAP
+	if (this->end_pos <= this->start_pos) return;
+
+	/* The mapping has to start at a page boundary, which files in a tar usually do not. */
+	static const size_t page_size = sysconf(_SC_PAGESIZE);
+	this->mapping_pos = this->start_pos - this->start_pos % page_size;
+	this->mapping_size = this->end_pos - this->mapping_pos;
+
+	void *mapping = mmap(nullptr, this->mapping_size, PROT_READ, MAP_PRIVATE, fileno(*this->file_handle), this->mapping_pos);
+	if (mapping == MAP_FAILED) {
+		Debug(misc, 1, "Mapping {} into memory failed, reading it instead", this->filename);
+		return;
+	}
+	this->mapping = static_cast<uint8_t *>(mapping);
+#endif
+}
+
 /**
  * Get the filename of the opened file with the path from the SubDirectory and the extension.
  * @return Name of the file.
@@ -91,6 +129,15 @@ void RandomAccessFile::SeekTo(size_t pos, int mode)
 {
 	if (mode == SEEK_CUR) pos += this->GetPos();
 
+	if (this->mapping != nullptr) {
+		/* Point the buffer at the mapping, so reads need neither copies nor system calls. */
+		pos = std::clamp(pos, this->mapping_pos, this->end_pos);
+		this->buffer = this->mapping + (pos - this->mapping_pos);
+		this->buffer_end = this->mapping + this->mapping_size;
+		this->pos = this->end_pos;
+		return;
+	}
+
 	this->pos = pos;
 	if (fseek(*this->file_handle, this->pos, SEEK_SET) < 0) {
 		Debug(misc, 0, "Seeking in {} failed", this->filename);
@@ -107,6 +154,9 @@ void RandomAccessFile::SeekTo(size_t pos, int mode)
 uint8_t RandomAccessFile::ReadByte()
 {
 	if (this->buffer == this->buffer_end) {
+		/* The whole file is mapped, so we are at its end. */
+		if (this->mapping != nullptr) return 0;
+
 		this->buffer = this->buffer_start;
 		size_t size = fread(this->buffer, 1, RandomAccessFile::BUFFER_SIZE, *this->file_handle);
 		this->pos += size;
@@ -153,6 +203,9 @@ void RandomAccessFile::ReadBlock(void *ptr, size_t size)
 		ptr = static_cast<char *>(ptr) + to_copy;
 	}
 
+	/* The whole file is mapped, so we are at its end. */
+	if (this->mapping != nullptr) return;
+
 	this->pos += fread(ptr, 1, size, *this->file_handle);
 }
 
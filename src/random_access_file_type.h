@@ -31,16 +31,22 @@ class RandomAccessFile {
 	size_t start_pos; ///< Start position of file. May be non-zero if file is within a tar file.
 	size_t end_pos; ///< End position of file.
 
-	uint8_t *buffer;                    ///< Current position within the local buffer.
+	uint8_t *buffer;                    ///< Current position within the local buffer, or within the memory mapping.
 	uint8_t *buffer_end;                ///< Last valid byte of buffer.
 	uint8_t buffer_start[BUFFER_SIZE];  ///< Local buffer when read from file.
 
+	uint8_t *mapping = nullptr; ///< Memory mapping of the file, or \c nullptr when it is read through the file handle.
+	size_t mapping_size = 0;    ///< Size of the memory mapping.
+	size_t mapping_pos = 0;     ///< Position in the file of the start of the memory mapping.
+
+	void MapFile();
+
 public:
 	RandomAccessFile(const std::string &filename, Subdirectory subdir);
 	RandomAccessFile(const RandomAccessFile&) = delete;
 	void operator=(const RandomAccessFile&) = delete;
 
-	virtual ~RandomAccessFile() = default;
+	virtual ~RandomAccessFile();
 
 	const std::string &GetFilename() const;
 	const std::string &GetSimplifiedFilename() const;
@@ -63,6 +63,7 @@
 #include "../timer/timer_game_calendar.h"
 #include "../timer/timer_game_economy.h"
 #include "../timer/timer_game_tick.h"
+#include "../thread.h"
 
 #include "saveload_internal.h"
 
@@ -558,6 +559,82 @@ static void StartScripts()
 	ShowScriptDebugWindowIfScriptError();
 }
 
+/** Logs how long each phase of AfterLoadGame took, at debug level sl=3. */
+class AfterLoadTimer {
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point start = Clock::now(); ///< Start of the whole after load.
+	Clock::time_point phase_start = start; ///< Start of the current phase.
+	std::string_view phase{}; ///< Name of the current phase, empty if none.
+
+public:
+	~AfterLoadTimer()
+	{
+		this->Phase({});
+		Debug(sl, 3, "AfterLoadGame took {} us in total", std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - this->start).count());
+	}
+
+	/**
+	 * End the current phase, and start a new one.
+	 * @param name Name of the new phase.
+	 */
+	void Phase(std::string_view name)
+	{
+		Clock::time_point now = Clock::now();
+		if (!this->phase.empty()) Debug(sl, 3, "AfterLoadGame: {} took {} us", this->phase, std::chrono::duration_cast<std::chrono::microseconds>(now - this->phase_start).count());
+		this->phase = name;
+		this->phase_start = now;
+	}
+};
+
+/**
+ * Run independent after load passes concurrently.
+ * The passes may not touch any state another pass of the same call touches, and may not throw.
+ * @param passes The passes to run.
+ */
+static void RunConcurrently(std::initializer_list<std::function<void()>> passes)
+{
+	bool threaded = std::thread::hardware_concurrency() > 1;
+	std::vector<std::thread> threads(passes.size() - 1);
+
+	auto thread = threads.begin();
+	for (auto pass = std::next(passes.begin()); pass != passes.end(); ++pass, ++thread) {
+		if (!threaded || !StartNewThread(&*thread, "ottd:afterload", [pass]() { (*pass)(); })) (*pass)();
+	}
+	(*passes.begin())();
+
+	for (std::thread &t : threads) {
+		if (t.joinable()) t.join();
+	}
+}
+
+/**
+ * Run a per-tile conversion over the whole map, split into stripes of rows that are converted concurrently.
+ * The conversion may only read and write the tile it is given, and may not throw.
+ * @param proc The conversion to run for each tile.
+ */
+template <typename Tproc>
+static void IterateMapConcurrently(Tproc proc)
+{
+	uint stripes = std::clamp(std::thread::hardware_concurrency(), 1U, Map::SizeY());
+	uint rows = CeilDiv(Map::SizeY(), stripes);
+
+	auto convert = [&proc, rows](uint stripe) {
+		uint end = std::min(Map::SizeY(), (stripe + 1) * rows) * Map::SizeX();
+		for (uint t = stripe * rows * Map::SizeX(); t < end; t++) proc(Tile(t));
+	};
+
+	std::vector<std::thread> threads(stripes - 1);
+	for (uint stripe = 1; stripe < stripes; stripe++) {
+		if (!StartNewThread(&threads[stripe - 1], "ottd:afterload", [&convert, stripe]() { convert(stripe); })) convert(stripe);
+	}
+	convert(0);
+
+	for (std::thread &t : threads) {
+		if (t.joinable()) t.join();
+	}
+}
+
 /**
  * Perform a (large) amount of savegame conversion *magic* in order to
  * load older savegames and to fill the caches for various purposes.
@@ -565,6 +642,7 @@ static void StartScripts()
  */
 bool AfterLoadGame()
 {
+	AfterLoadTimer timer;
 	SetSignalHandlers();
 
 	extern TileIndex _cur_tileloop_tile; // From landscape.cpp.
@@ -576,11 +654,12 @@ bool AfterLoadGame()
 	_gamelog.TestRevision();
 	_gamelog.TestMode();
 
-	RebuildTownKdtree();
-	RebuildStationKdtree();
-	/* This needs to be done even before conversion, because some conversions will destroy objects
-	 * that otherwise won't exist in the tree. */
-	RebuildViewportKdtree();
+	timer.Phase("kd-trees");
+	/* The viewport kd-tree needs to be built even before conversion, because some conversions will
+	 * destroy objects that otherwise won't exist in the tree. The trees are independent of each other
+	 * and building them only reads the pools, so build them concurrently. */
+	RunConcurrently({RebuildTownKdtree, RebuildStationKdtree, RebuildViewportKdtree});
+	timer.Phase("early conversions");
 
 	if (IsSavegameVersionBefore(SLV_98)) _gamelog.GRFAddList(_grfconfig);
 
@@ -630,7 +709,7 @@ bool AfterLoadGame()
 		_settings_game.construction.map_height_limit = 15;
 
 		/* In old savegame versions, the heightlevel was coded in bits 0..3 of the type field */
-		for (auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			t.height() = GB(t.type(), 0, 4);
 			SB(t.type(), 0, 2, GB(t.m6(), 0, 2));
 			SB(t.m6(), 0, 2, 0);
@@ -640,7 +719,7 @@ bool AfterLoadGame()
 			} else {
 				SB(t.type(), 2, 2, 0);
 			}
-		}
+		});
 	}
 
 	/* in version 2.1 of the savegame, town owner was unified. */
@@ -657,11 +736,11 @@ bool AfterLoadGame()
 	 * (4.3) version, so I just check when versions are older, and then
 	 * walk through the whole map.. */
 	if (IsSavegameVersionBefore(SLV_4, 3)) {
-		for (const auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			if (IsTileType(t, MP_WATER) && GetTileOwner(t) >= MAX_COMPANIES) {
 				SetTileOwner(t, OWNER_WATER);
 			}
-		}
+		});
 	}
 
 	if (IsSavegameVersionBefore(SLV_84)) {
@@ -798,6 +877,7 @@ bool AfterLoadGame()
 	}
 
 	/* Load the sprites */
+	timer.Phase("sprites");
 	GfxLoadSprites();
 	LoadStringWidthTable();
 
@@ -820,7 +900,9 @@ bool AfterLoadGame()
 	CargoPacket::AfterLoad();
 
 	/* Update all vehicles: Phase 1 */
+	timer.Phase("vehicles phase 1");
 	AfterLoadVehiclesPhase1(true);
+	timer.Phase("map conversions");
 
 	/* make sure there is a town in the game */
 	if (_game_mode == GM_NORMAL && Town::GetNumItems() == 0) {
@@ -1443,7 +1525,9 @@ bool AfterLoadGame()
 		c->avail_roadtypes = GetCompanyRoadTypes(c->index);
 	}
 
+	timer.Phase("stations");
 	AfterLoadStations();
+	timer.Phase("town conversions");
 
 	/* Time starts at 0 instead of 1920.
 	 * Account for this in older games by adding an offset */
@@ -1506,7 +1590,7 @@ bool AfterLoadGame()
 	/* From version 53, the map array was changed for house tiles to allow
 	 * space for newhouses grf features. A new byte, m7, was also added. */
 	if (IsSavegameVersionBefore(SLV_53)) {
-		for (auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			if (IsTileType(t, MP_HOUSE)) {
 				if (GB(t.m3(), 6, 2) != TOWN_HOUSE_COMPLETED) {
 					/* Move the construction stage from m3[7..6] to m5[5..4].
@@ -1536,22 +1620,24 @@ bool AfterLoadGame()
 					SetHouseCompleted(t, true);
 				}
 			}
-		}
+		});
 	}
 
 	if (IsSavegameVersionBefore(SLV_INCREASE_HOUSE_LIMIT)) {
-		for (auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			if (IsTileType(t, MP_HOUSE)) {
 				/* House type is moved from m4 + m3[6] to m8. */
 				SetHouseType(t, t.m4() | (GB(t.m3(), 6, 1) << 8));
 				t.m4() = 0;
 				ClrBit(t.m3(), 6);
 			}
-		}
+		});
 	}
 
 	/* Check and update house and town values */
+	timer.Phase("houses and towns");
 	UpdateHousesAndTowns();
+	timer.Phase("game state conversions");
 
 	if (IsSavegameVersionBefore(SLV_43)) {
 		for (auto t : Map::Iterate()) {
@@ -1674,7 +1760,7 @@ bool AfterLoadGame()
 	if (IsSavegameVersionBefore(SLV_64)) {
 		/* Since now we allow different signal types and variants on a single tile.
 		 * Move signal states to m4 to make room and clone the signal type/variant. */
-		for (auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			if (IsTileType(t, MP_RAILWAY) && HasSignals(t)) {
 				/* move signal states */
 				SetSignalStates(t, GB(t.m2(), 4, 4));
@@ -1682,7 +1768,7 @@ bool AfterLoadGame()
 				/* clone signal type and variant */
 				SB(t.m2(), 4, 3, GB(t.m2(), 0, 3));
 			}
-		}
+		});
 	}
 
 	if (IsSavegameVersionBefore(SLV_69)) {
@@ -1719,11 +1805,11 @@ bool AfterLoadGame()
 	 * making floods using the removal of ship depots.
 	 */
 	if (IsSavegameVersionBefore(SLV_83)) {
-		for (auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			if (IsShipDepotTile(t)) {
 				t.m4() = (TileHeight(t) == 0) ? OWNER_WATER : OWNER_NONE;
 			}
-		}
+		});
 	}
 
 	if (IsSavegameVersionBefore(SLV_74)) {
@@ -1762,12 +1848,12 @@ bool AfterLoadGame()
 	 * land used to have zero density, now they have full density. Therefore,
 	 * make all grassy/rough land trees have a density of 3. */
 	if (IsSavegameVersionBefore(SLV_81)) {
-		for (auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			if (GetTileType(t) == MP_TREES) {
 				TreeGround groundType = (TreeGround)GB(t.m2(), 4, 2);
 				if (groundType != TREE_GROUND_SNOW_DESERT) SB(t.m2(), 6, 2, 3);
 			}
-		}
+		});
 	}
 
 
@@ -2968,7 +3054,9 @@ bool AfterLoadGame()
 	/* Beyond this point, tile types which can be accessed by vehicles must be in a valid state. */
 
 	/* Update all vehicles: Phase 2 */
+	timer.Phase("vehicles phase 2");
 	AfterLoadVehiclesPhase2(true);
+	timer.Phase("vehicle conversions");
 
 	/* The center of train vehicles was changed, fix up spacing. */
 	if (IsSavegameVersionBefore(SLV_164)) FixupTrainLengths();
@@ -3149,9 +3237,9 @@ bool AfterLoadGame()
 
 	if (IsSavegameVersionBefore(SLV_TREES_WATER_CLASS)) {
 		/* Update water class for trees. */
-		for (const auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			if (IsTileType(t, MP_TREES)) SetWaterClass(t, GetTreeGround(t) == TREE_GROUND_SHORE ? WATER_CLASS_SEA : WATER_CLASS_INVALID);
-		}
+		});
 	}
 
 	/* Update structures for multitile docks */
@@ -3178,11 +3266,11 @@ bool AfterLoadGame()
 
 	if (IsSavegameVersionBeforeOrAt(SLV_ENDING_YEAR)) {
 		/* Reset roadtype/streetcartype info for non-road bridges. */
-		for (const auto t : Map::Iterate()) {
+		IterateMapConcurrently([](Tile t) {
 			if (IsTileType(t, MP_TUNNELBRIDGE) && GetTunnelBridgeTransportType(t) != TRANSPORT_ROAD) {
 				SetRoadTypes(t, INVALID_ROADTYPE, INVALID_ROADTYPE);
 			}
-		}
+		});
 	}
 
 	/* Make sure all industries exclusive supplier/consumer set correctly. */
@@ -3218,6 +3306,7 @@ bool AfterLoadGame()
 	}
 
 	/* Road stops is 'only' updating some caches, but they are needed for PF calls in SLV_MULTITRACK_LEVEL_CROSSINGS teleporting. */
+	timer.Phase("road stops and crossings");
 	AfterLoadRoadStops();
 
 	/* Road vehicles stopped on multitrack level crossings need teleporting to a depot
@@ -3261,11 +3350,11 @@ bool AfterLoadGame()
 
 		if (IsSavegameVersionBeforeOrAt(SLV_MULTITRACK_LEVEL_CROSSINGS)) {
 			/* Reset unused tree counters to reduce the savegame size. */
-			for (auto t : Map::Iterate()) {
+			IterateMapConcurrently([](Tile t) {
 				if (IsTileType(t, MP_TREES)) {
 					SB(t.m2(), 0, 4, 0);
 				}
-			}
+			});
 		}
 
 		/* Refresh all level crossings to bar adjacent crossing tiles, if needed. */
@@ -3274,6 +3363,7 @@ bool AfterLoadGame()
 		}
 	}
 
+	timer.Phase("catchment and late conversions");
 	/* Compute station catchment areas. This is needed here in case UpdateStationAcceptance is called below. */
 	Station::RecomputeCatchmentForAll();
 
@@ -3341,17 +3431,21 @@ bool AfterLoadGame()
 		}
 	}
 
+	timer.Phase("company stats");
 	AfterLoadLabelMaps();
 	AfterLoadCompanyStats();
 	AfterLoadStoryBook();
 
 	_gamelog.PrintDebug(1);
 
+	timer.Phase("windows and caches");
 	InitializeWindowsAndCaches();
 	/* Restore the signals */
 	ResetSignalHandlers();
 
+	timer.Phase("link graphs");
 	AfterLoadLinkGraphs();
+	timer.Phase("scripts and companies");
 
 	CheckGroundVehiclesAtCorrectZ();
 
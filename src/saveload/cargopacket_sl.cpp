@@ -149,6 +149,9 @@ struct CAPAChunkHandler : ChunkHandler {
 	{
 		SlTableHeader(GetCargoPacketDesc());
 
+		/* Only the packets themselves are saved, so they have to be fully aged. */
+		for (Vehicle *v : Vehicle::Iterate()) v->cargo.ApplyAging();
+
 		for (CargoPacket *cp : CargoPacket::Iterate()) {
 			SlSetArrayIndex(cp->index);
 			SlObject(cp, GetCargoPacketDesc());
@@ -66,6 +66,36 @@ struct MAPSChunkHandler : ChunkHandler {
 
 static const uint MAP_SL_BUF_SIZE = 4096;
 
+/**
+ * Make room at the end of a buffer.
+ * @param buffer The buffer to grow.
+ * @param length Number of bytes to add.
+ * @return Pointer to the added bytes.
+ */
+static uint8_t *GrowBuffer(std::vector<uint8_t> &buffer, size_t length)
+{
+	size_t start = buffer.size();
+	buffer.resize(start + length);
+	return buffer.data() + start;
+}
+
+/**
+ * Load an array of 16 bits values per tile, reading the bytes in bulk.
+ * @param field Function returning a reference to the value of a tile.
+ */
+template <typename Tfield>
+static void LoadMapUint16(Tfield field)
+{
+	std::array<uint8_t, MAP_SL_BUF_SIZE * sizeof(uint16_t)> buf;
+	uint size = Map::Size();
+
+	for (TileIndex i{}; i != size;) {
+		SlCopy(buf.data(), buf.size(), SLE_UINT8);
+		/* Stored big endian. */
+		for (uint j = 0; j != buf.size(); j += 2) field(Tile(i++)) = buf[j] << 8 | buf[j + 1];
+	}
+}
+
 struct MAPTChunkHandler : ChunkHandler {
 	MAPTChunkHandler() : ChunkHandler('MAPT', CH_RIFF) {}
 
@@ -80,16 +110,14 @@ struct MAPTChunkHandler : ChunkHandler {
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint8_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(size);
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).type();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		}
+		uint8_t *out = GrowBuffer(buffer, size);
+		for (TileIndex i{}; i != size; i++) *out++ = Tile(i).type();
 	}
 };
 
@@ -107,16 +135,14 @@ struct MAPHChunkHandler : ChunkHandler {
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint8_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(size);
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).height();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		}
+		uint8_t *out = GrowBuffer(buffer, size);
+		for (TileIndex i{}; i != size; i++) *out++ = Tile(i).height();
 	}
 };
 
@@ -134,16 +160,14 @@ struct MAPOChunkHandler : ChunkHandler {
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint8_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(size);
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).m1();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		}
+		uint8_t *out = GrowBuffer(buffer, size);
+		for (TileIndex i{}; i != size; i++) *out++ = Tile(i).m1();
 	}
 };
 
@@ -152,27 +176,33 @@ struct MAP2ChunkHandler : ChunkHandler {
 
 	void Load() const override
 	{
+		if (!IsSavegameVersionBefore(SLV_5)) {
+			LoadMapUint16([](Tile t) -> uint16_t & { return t.m2(); });
+			return;
+		}
+
 		std::array<uint16_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
 		for (TileIndex i{}; i != size;) {
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE,
-				/* In those versions the m2 was 8 bits */
-				IsSavegameVersionBefore(SLV_5) ? SLE_FILE_U8 | SLE_VAR_U16 : SLE_UINT16
-			);
+			/* In those versions the m2 was 8 bits */
+			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_FILE_U8 | SLE_VAR_U16);
 			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) Tile(i++).m2() = buf[j];
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint16_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(static_cast<uint32_t>(size) * sizeof(uint16_t));
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).m2();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT16);
+		/* Stored big endian, like SlCopy does. */
+		uint8_t *out = GrowBuffer(buffer, size * sizeof(uint16_t));
+		for (TileIndex i{}; i != size; i++) {
+			uint16_t m2 = Tile(i).m2();
+			*out++ = GB(m2, 8, 8);
+			*out++ = GB(m2, 0, 8);
 		}
 	}
 };
@@ -191,16 +221,14 @@ struct M3LOChunkHandler : ChunkHandler {
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint8_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(size);
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).m3();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		}
+		uint8_t *out = GrowBuffer(buffer, size);
+		for (TileIndex i{}; i != size; i++) *out++ = Tile(i).m3();
 	}
 };
 
@@ -218,16 +246,14 @@ struct M3HIChunkHandler : ChunkHandler {
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint8_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(size);
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).m4();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		}
+		uint8_t *out = GrowBuffer(buffer, size);
+		for (TileIndex i{}; i != size; i++) *out++ = Tile(i).m4();
 	}
 };
 
@@ -245,16 +271,14 @@ struct MAP5ChunkHandler : ChunkHandler {
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint8_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(size);
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).m5();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		}
+		uint8_t *out = GrowBuffer(buffer, size);
+		for (TileIndex i{}; i != size; i++) *out++ = Tile(i).m5();
 	}
 };
 
@@ -285,16 +309,14 @@ struct MAPEChunkHandler : ChunkHandler {
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint8_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(size);
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).m6();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		}
+		uint8_t *out = GrowBuffer(buffer, size);
+		for (TileIndex i{}; i != size; i++) *out++ = Tile(i).m6();
 	}
 };
 
@@ -312,16 +334,14 @@ struct MAP7ChunkHandler : ChunkHandler {
 		}
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint8_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(size);
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).m7();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		}
+		uint8_t *out = GrowBuffer(buffer, size);
+		for (TileIndex i{}; i != size; i++) *out++ = Tile(i).m7();
 	}
 };
 
@@ -330,24 +350,21 @@ struct MAP8ChunkHandler : ChunkHandler {
 
 	void Load() const override
 	{
-		std::array<uint16_t, MAP_SL_BUF_SIZE> buf;
-		uint size = Map::Size();
-
-		for (TileIndex i{}; i != size;) {
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT16);
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) Tile(i++).m8() = buf[j];
-		}
+		LoadMapUint16([](Tile t) -> uint16_t & { return t.m8(); });
 	}
 
-	void Save() const override
+	bool CanSaveToBuffer() const override { return true; }
+
+	void SaveToBuffer(std::vector<uint8_t> &buffer) const override
 	{
-		std::array<uint16_t, MAP_SL_BUF_SIZE> buf;
 		uint size = Map::Size();
 
-		SlSetLength(static_cast<uint32_t>(size) * sizeof(uint16_t));
-		for (TileIndex i{}; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = Tile(i++).m8();
-			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT16);
+		/* Stored big endian, like SlCopy does. */
+		uint8_t *out = GrowBuffer(buffer, size * sizeof(uint16_t));
+		for (TileIndex i{}; i != size; i++) {
+			uint16_t m8 = Tile(i).m8();
+			*out++ = GB(m8, 8, 8);
+			*out++ = GB(m8, 0, 8);
 		}
 	}
 };
@@ -29,6 +29,7 @@
 #include "../window_func.h"
 #include "../strings_func.h"
 #include "../core/endian_func.hpp"
+#include "../core/backup_type.hpp"
 #include "../vehicle_base.h"
 #include "../company_func.h"
 #include "../timer/timer_game_economy.h"
@@ -46,6 +47,16 @@
 #ifdef __EMSCRIPTEN__
 #	include <emscripten.h>
 #endif
+/* The forked child keeps allocating memory and starting threads, which only the
+ * fork handlers of glibc keep working in the child of a multi-threaded process. */
+#if defined(UNIX) && !defined(__EMSCRIPTEN__) && defined(__GLIBC__)
+#	include <charconv>
+#	include <filesystem>
+#	include <sys/stat.h>
+#	include <sys/wait.h>
+#	include <unistd.h>
+#	define WITH_FORKED_SAVE
+#endif
 
 #include "table/strings.h"
 
@@ -63,6 +74,8 @@ uint32_t _ttdp_version;         ///< version of TTDP savegame (if applicable)
 SaveLoadVersion _sl_version;  ///< the major savegame version identifier
 uint8_t   _sl_minor_version;     ///< the minor savegame version, DO NOT USE!
 std::string _savegame_format; ///< how to compress savegames
+std::string _autosave_format; ///< how to compress autosaves; empty to compress them like other savegames
+uint8_t _autosave_deltas;     ///< number of delta autosaves written after each full autosave
 bool _do_autosave;            ///< are we doing an autosave at the moment?
 
 /** What are we currently doing? */
@@ -83,6 +96,23 @@ enum NeedLength {
 /** Save in chunks of 128 KiB. */
 static const size_t MEMORY_CHUNK_SIZE = 128 * 1024;
 
+static const uint32_t DELTA_BASE_CHUNK_ID = 'BASE'; ///< Chunk at the start of a delta savegame with the name of its base savegame.
+static const uint8_t CH_BASE_REFERENCE = 0xF; ///< Chunk type of a chunk of a delta savegame that is the same as in its base savegame.
+static const uint64_t CHUNK_HASH_OFFSET_BASIS = 0xCBF29CE484222325; ///< Start value of the FNV-1a hash of a chunk.
+static const uint64_t CHUNK_HASH_PRIME = 0x100000001B3; ///< Multiplier of the FNV-1a hash of a chunk.
+
+/**
+ * Add data of a chunk to its hash.
+ * @param hash The hash so far.
+ * @param data The data to add.
+ * @return The new hash.
+ */
+static uint64_t HashChunkData(uint64_t hash, std::span<const uint8_t> data)
+{
+	for (uint8_t b : data) hash = (hash ^ b) * CHUNK_HASH_PRIME;
+	return hash;
+}
+
 /** A buffer for reading (and buffering) savegame data. */
 struct ReadBuffer {
 	uint8_t buf[MEMORY_CHUNK_SIZE]; ///< Buffer we're going to read from.
@@ -99,20 +129,42 @@ struct ReadBuffer {
 	{
 	}
 
-	inline uint8_t ReadByte()
+	/** Fill the buffer with the next bytes from the filter. */
+	inline void FillBuffer()
 	{
-		if (this->bufp == this->bufe) {
-			size_t len = this->reader->Read(this->buf, lengthof(this->buf));
-			if (len == 0) SlErrorCorrupt("Unexpected end of chunk");
+		size_t len = this->reader->Read(this->buf, lengthof(this->buf));
+		if (len == 0) SlErrorCorrupt("Unexpected end of chunk");
 
-			this->read += len;
-			this->bufp = this->buf;
-			this->bufe = this->buf + len;
-		}
+		this->read += len;
+		this->bufp = this->buf;
+		this->bufe = this->buf + len;
+	}
+
+	inline uint8_t ReadByte()
+	{
+		if (this->bufp == this->bufe) this->FillBuffer();
 
 		return *this->bufp++;
 	}
 
+	/**
+	 * Read a number of bytes at once.
+	 * @param ptr The buffer to read into.
+	 * @param length The number of bytes to read.
+	 */
+	inline void ReadBytes(uint8_t *ptr, size_t length)
+	{
+		while (length != 0) {
+			if (this->bufp == this->bufe) this->FillBuffer();
+
+			size_t to_copy = std::min<size_t>(this->bufe - this->bufp, length);
+			std::copy_n(this->bufp, to_copy, ptr);
+			this->bufp += to_copy;
+			ptr += to_copy;
+			length -= to_copy;
+		}
+	}
+
 	/**
 	 * Get the size of the memory dump made so far.
 	 * @return The size.
@@ -129,6 +181,7 @@ struct MemoryDumper {
 	std::vector<std::unique_ptr<uint8_t[]>> blocks{}; ///< Buffer with blocks of allocated memory.
 	uint8_t *buf = nullptr; ///< Buffer we're going to write to.
 	uint8_t *bufe = nullptr; ///< End of the buffer we write to.
+	std::vector<std::pair<size_t, std::vector<uint8_t>>> inserts{}; ///< Data dumped elsewhere, with the position in this dump it has to be written at.
 
 	/**
 	 * Write a single byte into the dumper.
@@ -137,30 +190,93 @@ struct MemoryDumper {
 	inline void WriteByte(uint8_t b)
 	{
 		/* Are we at the end of this chunk? */
-		if (this->buf == this->bufe) {
-			this->buf = this->blocks.emplace_back(std::make_unique<uint8_t[]>(MEMORY_CHUNK_SIZE)).get();
-			this->bufe = this->buf + MEMORY_CHUNK_SIZE;
-		}
+		if (this->buf == this->bufe) this->AllocateBlock();
 
 		*this->buf++ = b;
 	}
 
+	/**
+	 * Write a number of bytes at once.
+	 * @param ptr The bytes to write.
+	 * @param length The number of bytes to write.
+	 */
+	inline void WriteBytes(const uint8_t *ptr, size_t length)
+	{
+		while (length != 0) {
+			if (this->buf == this->bufe) this->AllocateBlock();
+
+			size_t to_copy = std::min<size_t>(this->bufe - this->buf, length);
+			std::copy_n(ptr, to_copy, this->buf);
+			this->buf += to_copy;
+			ptr += to_copy;
+			length -= to_copy;
+		}
+	}
+
+	/** Start writing to a new block. */
+	inline void AllocateBlock()
+	{
+		this->buf = this->blocks.emplace_back(std::make_unique<uint8_t[]>(MEMORY_CHUNK_SIZE)).get();
+		this->bufe = this->buf + MEMORY_CHUNK_SIZE;
+	}
+
 	/**
 	 * Flush this dumper into a writer.
 	 * @param writer The filter we want to use.
 	 */
 	void Flush(std::shared_ptr<SaveFilter> writer)
 	{
-		uint i = 0;
-		size_t t = this->GetSize();
+		if (this->inserts.empty()) {
+			uint i = 0;
+			size_t t = this->GetSize();
 
-		while (t > 0) {
-			size_t to_write = std::min(MEMORY_CHUNK_SIZE, t);
+			while (t > 0) {
+				size_t to_write = std::min(MEMORY_CHUNK_SIZE, t);
 
-			writer->Write(this->blocks[i++].get(), to_write);
-			t -= to_write;
+				writer->Write(this->blocks[i++].get(), to_write);
+				t -= to_write;
+			}
+
+			writer->Finish();
+			return;
 		}
 
+		/* Some filters compress per write, so hand the data to the writer in
+		 * the same pieces as if everything had been dumped in here. */
+		auto out = std::make_unique<uint8_t[]>(MEMORY_CHUNK_SIZE);
+		size_t out_len = 0;
+		auto write = [&](const uint8_t *data, size_t len) {
+			while (len > 0) {
+				size_t to_copy = std::min(MEMORY_CHUNK_SIZE - out_len, len);
+				std::copy_n(data, to_copy, out.get() + out_len);
+				out_len += to_copy;
+				data += to_copy;
+				len -= to_copy;
+
+				if (out_len == MEMORY_CHUNK_SIZE) {
+					writer->Write(out.get(), out_len);
+					out_len = 0;
+				}
+			}
+		};
+		auto write_dumped = [&](size_t from, size_t to) {
+			while (from < to) {
+				size_t offset = from % MEMORY_CHUNK_SIZE;
+				size_t len = std::min(MEMORY_CHUNK_SIZE - offset, to - from);
+				write(this->blocks[from / MEMORY_CHUNK_SIZE].get() + offset, len);
+				from += len;
+			}
+		};
+
+		size_t pos = 0;
+		for (const auto &[offset, data] : this->inserts) {
+			write_dumped(pos, offset);
+			write(data.data(), data.size());
+			pos = offset;
+		}
+		write_dumped(pos, this->GetSize());
+		if (out_len > 0) writer->Write(out.get(), out_len);
+
 		writer->Finish();
 	}
 
@@ -172,8 +288,52 @@ struct MemoryDumper {
 	{
 		return this->blocks.size() * MEMORY_CHUNK_SIZE - (this->bufe - this->buf);
 	}
+
+	/**
+	 * Throw away everything dumped from a given position on.
+	 * @param size The size to shrink the dump to.
+	 */
+	void Truncate(size_t size)
+	{
+		assert(size <= this->GetSize());
+
+		this->blocks.resize((size + MEMORY_CHUNK_SIZE - 1) / MEMORY_CHUNK_SIZE);
+		if (this->blocks.empty()) {
+			this->buf = this->bufe = nullptr;
+			return;
+		}
+
+		this->bufe = this->blocks.back().get() + MEMORY_CHUNK_SIZE;
+		this->buf = this->bufe - (this->blocks.size() * MEMORY_CHUNK_SIZE - size);
+	}
+
+	/**
+	 * Get the hash of everything dumped from a given position on.
+	 * @param from The position to start hashing at.
+	 * @return The FNV-1a hash of the data.
+	 */
+	uint64_t Hash(size_t from) const
+	{
+		uint64_t hash = CHUNK_HASH_OFFSET_BASIS;
+		for (size_t to = this->GetSize(); from < to;) {
+			size_t offset = from % MEMORY_CHUNK_SIZE;
+			size_t len = std::min(MEMORY_CHUNK_SIZE - offset, to - from);
+			hash = HashChunkData(hash, {this->blocks[from / MEMORY_CHUNK_SIZE].get() + offset, len});
+			from += len;
+		}
+		return hash;
+	}
 };
 
+/** The full autosave that delta autosaves refer to. */
+struct DeltaSaveBase {
+	std::string filename; ///< Name of the full autosave in the autosave directory; empty when there is none.
+	std::map<uint32_t, uint64_t> chunk_hashes; ///< Hash of each chunk in the full autosave.
+	uint8_t deltas = 0; ///< Number of delta autosaves written since the full autosave.
+};
+
+static DeltaSaveBase _delta_save_base; ///< The last full autosave, written while delta autosaves are enabled.
+
 /** The saveload struct, containing reader-writer functions, buffer, version, etc. */
 struct SaveLoadParams {
 	SaveLoadAction action;               ///< are we doing a save or a load atm.
@@ -187,9 +347,17 @@ struct SaveLoadParams {
 
 	std::unique_ptr<MemoryDumper> dumper; ///< Memory dumper to write the savegame to.
 	std::shared_ptr<SaveFilter> sf; ///< Filter to write the savegame to.
+	std::string format;                  ///< How to compress the savegame being written.
+	std::string filename;                ///< Name of the autosave being written.
+	bool hash_chunks;                    ///< Whether the autosave being written is a full or delta autosave for delta autosaves.
+	std::string delta_base;              ///< Name of the base of the delta autosave being written; empty when it is a full savegame.
+	std::map<uint32_t, uint64_t> chunk_hashes; ///< Hash of each chunk written, when the autosave being written is a full one.
 
 	std::unique_ptr<ReadBuffer> reader; ///< Savegame reading buffer.
 	std::shared_ptr<LoadFilter> lf; ///< Filter to read the savegame from.
+	bool allow_delta;                    ///< Whether the savegame being read is a file, which may be a delta savegame.
+	std::vector<uint8_t> base_data;      ///< The chunks of the base of the delta savegame being read.
+	std::map<uint32_t, std::pair<size_t, size_t>> base_chunks; ///< Begin and end of each chunk in #base_data, after its ID.
 
 	StringID error_str;                  ///< the translatable error message to show
 	std::string extra_msg;               ///< the error message
@@ -310,6 +478,8 @@ static void SlNullPointers()
 	assert(_sl.action == SLA_NULL);
 }
 
+static thread_local bool _sl_decompress_ahead = false; ///< Whether this thread is decompressing a savegame ahead of loading it.
+
 /**
  * Error handler. Sets everything up to show an error message and to clean
  * up the mess of a partial savegame load.
@@ -320,6 +490,9 @@ static void SlNullPointers()
  */
 [[noreturn]] void SlError(StringID string, const std::string &extra_msg)
 {
+	/* Decompressing ahead happens outside of any save or load, so it may not touch their state. */
+	if (_sl_decompress_ahead) throw std::exception();
+
 	/* Distinguish between loading into _load_check_data vs. normal save/load. */
 	if (_sl.action == SLA_LOAD_CHECK) {
 		_load_check_data.error = string;
@@ -357,6 +530,10 @@ static void SlNullPointers()
 typedef void (*AsyncSaveFinishProc)();                      ///< Callback for when the savegame loading is finished.
 static std::atomic<AsyncSaveFinishProc> _async_save_finish; ///< Callback to call when the savegame loading is finished.
 static std::thread _save_thread;                            ///< The thread we're using to compress and write a savegame
+#ifdef WITH_FORKED_SAVE
+static pid_t _save_process = -1;                            ///< The process writing a savegame from a snapshot of the game, or -1 if there is none.
+static void ReapSaveProcess(bool wait);
+#endif
 
 /**
  * Called by save thread to tell we finished saving.
@@ -375,6 +552,10 @@ static void SetAsyncSaveFinish(AsyncSaveFinishProc proc)
  */
 void ProcessAsyncSaveFinish()
 {
+#ifdef WITH_FORKED_SAVE
+	ReapSaveProcess(false);
+#endif
+
 	AsyncSaveFinishProc proc = _async_save_finish.exchange(nullptr, std::memory_order_acq_rel);
 	if (proc == nullptr) return;
 
@@ -769,10 +950,10 @@ static void SlCopyBytes(void *ptr, size_t length)
 	switch (_sl.action) {
 		case SLA_LOAD_CHECK:
 		case SLA_LOAD:
-			for (; length != 0; length--) *p++ = SlReadByte();
+			_sl.reader->ReadBytes(p, length);
 			break;
 		case SLA_SAVE:
-			for (; length != 0; length--) SlWriteByte(*p++);
+			_sl.dumper->WriteBytes(p, length);
 			break;
 		default: NOT_REACHED();
 	}
@@ -2028,6 +2209,8 @@ void ChunkHandler::LoadCheck(size_t len) const
 	}
 }
 
+static void SlLoadBaseChunk(const ChunkHandler &ch, bool load_check);
+
 /**
  * Load a chunk of data (eg vehicles, stations, etc.)
  * @param ch The chunkhandler that will be used for the operation
@@ -2035,6 +2218,10 @@ void ChunkHandler::LoadCheck(size_t len) const
 static void SlLoadChunk(const ChunkHandler &ch)
 {
 	uint8_t m = SlReadByte();
+	if (m == CH_BASE_REFERENCE) {
+		SlLoadBaseChunk(ch, false);
+		return;
+	}
 
 	_sl.block_mode = m & CH_TYPE_MASK;
 	_sl.obj_len = 0;
@@ -2088,6 +2275,10 @@ static void SlLoadChunk(const ChunkHandler &ch)
 static void SlLoadCheckChunk(const ChunkHandler &ch)
 {
 	uint8_t m = SlReadByte();
+	if (m == CH_BASE_REFERENCE) {
+		SlLoadBaseChunk(ch, true);
+		return;
+	}
 
 	_sl.block_mode = m & CH_TYPE_MASK;
 	_sl.obj_len = 0;
@@ -2142,6 +2333,7 @@ static void SlSaveChunk(const ChunkHandler &ch)
 
 	SlWriteUint32(ch.id);
 	Debug(sl, 2, "Saving chunk {}", ch.GetName());
+	size_t start = _sl.dumper->GetSize();
 
 	_sl.block_mode = ch.type;
 	_sl.expect_table_header = (_sl.block_mode == CH_TABLE || _sl.block_mode == CH_SPARSE_TABLE);
@@ -2169,17 +2361,104 @@ static void SlSaveChunk(const ChunkHandler &ch)
 	}
 
 	if (_sl.expect_table_header) SlErrorCorrupt("Table chunk without header");
+
+	if (!_sl.hash_chunks) return;
+
+	uint64_t hash = _sl.dumper->Hash(start);
+	if (_sl.delta_base.empty()) {
+		_sl.chunk_hashes[ch.id] = hash;
+		return;
+	}
+
+	/* Refer to the chunk in the base savegame when it did not change since, unless the reference is not smaller. */
+	auto it = _delta_save_base.chunk_hashes.find(ch.id);
+	if (it == _delta_save_base.chunk_hashes.end() || it->second != hash) return;
+	if (_sl.dumper->GetSize() - start <= sizeof(CH_BASE_REFERENCE) + sizeof(hash)) return;
+
+	Debug(sl, 2, "Chunk {} is the same as in the base savegame", ch.GetName());
+	_sl.dumper->Truncate(start);
+	SlWriteByte(CH_BASE_REFERENCE);
+	SlWriteUint64(hash);
 }
 
-/** Save all chunks */
+/**
+ * Save all chunks. Chunks which can be saved to a buffer are saved on other
+ * threads while the main thread saves the rest; their data is put at the
+ * right place when the dump is written, so the result is the same as when
+ * saving all chunks one after another.
+ */
 static void SlSaveChunks()
 {
-	for (auto &ch : ChunkHandlers()) {
-		SlSaveChunk(ch);
+	/* Chunks saved to a buffer and the buffers, starting with room for the RIFF header. */
+	std::vector<std::pair<const ChunkHandler *, std::vector<uint8_t>>> buffered;
+	for (const ChunkHandler &ch : ChunkHandlers()) {
+		if (ch.type == CH_RIFF && ch.CanSaveToBuffer()) buffered.emplace_back(&ch, std::vector<uint8_t>(4));
+	}
+
+	std::atomic<size_t> next_buffered = 0;
+	auto save_buffered = [&buffered, &next_buffered]() {
+		for (size_t i = next_buffered++; i < buffered.size(); i = next_buffered++) {
+			buffered[i].first->SaveToBuffer(buffered[i].second);
+		}
+	};
+
+	/* Keep one core for the main thread, which saves all other chunks. */
+	uint num_threads = std::min<uint>(static_cast<uint>(buffered.size()), std::max(std::thread::hardware_concurrency(), 2U) - 1);
+	std::vector<std::thread> threads(num_threads);
+	for (std::thread &thread : threads) {
+		if (!StartNewThread(&thread, "ottd:savechunk", [&save_buffered]() { save_buffered(); })) break;
+	}
+
+	/* The game state may not change while buffered chunks are still being saved. */
+	auto join_threads = [&threads]() {
+		for (std::thread &thread : threads) {
+			if (thread.joinable()) thread.join();
+		}
+	};
+
+	std::vector<size_t> offsets;
+	try {
+		if (!_sl.delta_base.empty()) {
+			SlWriteUint32(DELTA_BASE_CHUNK_ID);
+			SlWriteSimpleGamma(_sl.delta_base.size());
+			SlCopyBytes(_sl.delta_base.data(), _sl.delta_base.size());
+		}
+
+		for (const ChunkHandler &ch : ChunkHandlers()) {
+			if (ch.type == CH_RIFF && ch.CanSaveToBuffer()) {
+				SlWriteUint32(ch.id);
+				Debug(sl, 2, "Saving chunk {} to buffer", ch.GetName());
+				offsets.push_back(_sl.dumper->GetSize());
+				continue;
+			}
+			SlSaveChunk(ch);
+		}
+
+		/* Terminator */
+		SlWriteUint32(0);
+	} catch (...) {
+		join_threads();
+		throw;
 	}
 
-	/* Terminator */
-	SlWriteUint32(0);
+	/* Help with whatever buffered chunks are left. */
+	save_buffered();
+	join_threads();
+
+	for (size_t i = 0; i < buffered.size(); i++) {
+		std::vector<uint8_t> &data = buffered[i].second;
+
+		/* Same encoding of the RIFF length as SlSetLength. */
+		size_t length = data.size() - 4;
+		assert(length < (1 << 28));
+		uint32_t riff_length = (uint32_t)((length & 0xFFFFFF) | ((length >> 24) << 28));
+		data[0] = GB(riff_length, 24, 8);
+		data[1] = GB(riff_length, 16, 8);
+		data[2] = GB(riff_length, 8, 8);
+		data[3] = GB(riff_length, 0, 8);
+
+		_sl.dumper->inserts.emplace_back(offsets[i], std::move(data));
+	}
 }
 
 /**
@@ -2194,6 +2473,8 @@ static const ChunkHandler *SlFindChunkHandler(uint32_t id)
 	return nullptr;
 }
 
+static void SlReadDeltaBase();
+
 /** Load all chunks */
 static void SlLoadChunks()
 {
@@ -2203,6 +2484,11 @@ static void SlLoadChunks()
 	for (id = SlReadUint32(); id != 0; id = SlReadUint32()) {
 		Debug(sl, 2, "Loading chunk {:c}{:c}{:c}{:c}", id >> 24, id >> 16, id >> 8, id);
 
+		if (id == DELTA_BASE_CHUNK_ID) {
+			SlReadDeltaBase();
+			continue;
+		}
+
 		ch = SlFindChunkHandler(id);
 		if (ch == nullptr) SlErrorCorrupt("Unknown chunk type");
 		SlLoadChunk(*ch);
@@ -2218,6 +2504,11 @@ static void SlLoadCheckChunks()
 	for (id = SlReadUint32(); id != 0; id = SlReadUint32()) {
 		Debug(sl, 2, "Loading chunk {:c}{:c}{:c}{:c}", id >> 24, id >> 16, id >> 8, id);
 
+		if (id == DELTA_BASE_CHUNK_ID) {
+			SlReadDeltaBase();
+			continue;
+		}
+
 		ch = SlFindChunkHandler(id);
 		if (ch == nullptr) SlErrorCorrupt("Unknown chunk type");
 		SlLoadCheckChunk(*ch);
@@ -2678,6 +2969,218 @@ struct LZMASaveFilter : SaveFilter {
 	}
 };
 
+/*
+ * The block LZMA format splits the data into blocks which are compressed
+ * independently, so they can be compressed and decompressed concurrently.
+ * Each block is preceded by its uncompressed and compressed size as big
+ * endian 32 bits integers and holds a complete xz stream. The data ends
+ * with a block header with an uncompressed size of 0.
+ */
+
+static const size_t LZMA_BLOCK_SIZE = 4 * 1024 * 1024; ///< Maximum size of the uncompressed data of a block.
+
+/** A block of the block LZMA format. */
+struct LZMABlock {
+	std::vector<uint8_t> data;       ///< Uncompressed data.
+	std::vector<uint8_t> compressed; ///< Compressed data.
+	bool ok = false;                 ///< Whether (de)compressing the block succeeded.
+};
+
+/**
+ * Run a function on each of the blocks, each on its own thread.
+ * @param blocks The blocks.
+ * @param func The function to call for a block.
+ */
+template <typename Tfunc>
+static void ForEachLZMABlockConcurrently(std::vector<LZMABlock> &blocks, const Tfunc &func)
+{
+	std::vector<std::thread> threads(blocks.size());
+	for (size_t i = 1; i < blocks.size(); i++) {
+		LZMABlock &block = blocks[i];
+		if (!StartNewThread(&threads[i], "ottd:lzmablock", [&func, &block]() { func(block); })) func(block);
+	}
+	func(blocks[0]);
+
+	for (std::thread &thread : threads) {
+		if (thread.joinable()) thread.join();
+	}
+}
+
+/**
+ * Get the number of blocks to (de)compress at once.
+ * @return Number of blocks.
+ */
+static size_t GetConcurrentLZMABlocks()
+{
+	return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+/** Filter using LZMA compression in independent blocks. */
+struct LZMABlockLoadFilter : LoadFilter {
+	std::vector<LZMABlock> blocks; ///< Blocks decompressed in the last batch.
+	size_t current = 0;            ///< Block in #blocks to read from next.
+	size_t pos = 0;                ///< Position in the current block to read from next.
+	bool finished = false;         ///< Whether the end marker has been read.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	LZMABlockLoadFilter(std::shared_ptr<LoadFilter> chain) : LoadFilter(chain)
+	{
+	}
+
+	/**
+	 * Read exactly the given number of bytes from the chain.
+	 * @param buf The buffer to read into.
+	 * @param size The number of bytes to read.
+	 */
+	void ReadFully(uint8_t *buf, size_t size)
+	{
+		while (size > 0) {
+			size_t read = this->chain->Read(buf, size);
+			if (read == 0) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE);
+			buf += read;
+			size -= read;
+		}
+	}
+
+	/** Read the next batch of blocks and decompress them. */
+	void DecompressBlocks()
+	{
+		this->blocks.clear();
+		this->current = 0;
+		this->pos = 0;
+
+		while (!this->finished && this->blocks.size() < GetConcurrentLZMABlocks()) {
+			uint32_t hdr[2];
+			this->ReadFully((uint8_t*)hdr, sizeof(hdr));
+
+			size_t size = FROM_BE32(hdr[0]);
+			size_t compressed_size = FROM_BE32(hdr[1]);
+			if (size == 0) {
+				this->finished = true;
+				break;
+			}
+			if (size > LZMA_BLOCK_SIZE || compressed_size > lzma_stream_buffer_bound(LZMA_BLOCK_SIZE)) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE);
+
+			LZMABlock &block = this->blocks.emplace_back();
+			block.data.resize(size);
+			block.compressed.resize(compressed_size);
+			this->ReadFully(block.compressed.data(), compressed_size);
+		}
+
+		if (this->blocks.empty()) return;
+
+		ForEachLZMABlockConcurrently(this->blocks, [](LZMABlock &block) {
+			uint64_t memlimit = UINT64_MAX;
+			size_t in_pos = 0;
+			size_t out_pos = 0;
+			block.ok = lzma_stream_buffer_decode(&memlimit, 0, nullptr, block.compressed.data(), &in_pos, block.compressed.size(), block.data.data(), &out_pos, block.data.size()) == LZMA_OK &&
+					in_pos == block.compressed.size() && out_pos == block.data.size();
+		});
+
+		for (const LZMABlock &block : this->blocks) {
+			if (!block.ok) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "liblzma returned error code");
+		}
+	}
+
+	size_t Read(uint8_t *buf, size_t size) override
+	{
+		size_t read = 0;
+		while (read < size) {
+			if (this->current == this->blocks.size()) {
+				if (this->finished) break;
+				this->DecompressBlocks();
+				if (this->blocks.empty()) break;
+			}
+
+			const std::vector<uint8_t> &data = this->blocks[this->current].data;
+			size_t to_copy = std::min(data.size() - this->pos, size - read);
+			std::copy_n(data.data() + this->pos, to_copy, buf + read);
+			this->pos += to_copy;
+			read += to_copy;
+
+			if (this->pos == data.size()) {
+				this->current++;
+				this->pos = 0;
+			}
+		}
+
+		return read;
+	}
+};
+
+/** Filter using LZMA compression in independent blocks. */
+struct LZMABlockSaveFilter : SaveFilter {
+	std::vector<LZMABlock> blocks; ///< Blocks waiting to be compressed.
+	uint8_t compression_level;     ///< The requested level of compression.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain             The next filter in this chain.
+	 * @param compression_level The requested level of compression.
+	 */
+	LZMABlockSaveFilter(std::shared_ptr<SaveFilter> chain, uint8_t compression_level) : SaveFilter(chain), compression_level(compression_level)
+	{
+	}
+
+	/**
+	 * Write a block header.
+	 * @param size Size of the uncompressed data of the block.
+	 * @param compressed_size Size of the compressed data of the block.
+	 */
+	void WriteBlockHeader(size_t size, size_t compressed_size)
+	{
+		uint32_t hdr[2] = { TO_BE32(static_cast<uint32_t>(size)), TO_BE32(static_cast<uint32_t>(compressed_size)) };
+		this->chain->Write((uint8_t*)hdr, sizeof(hdr));
+	}
+
+	/** Compress the waiting blocks and write them. */
+	void CompressBlocks()
+	{
+		if (this->blocks.empty()) return;
+
+		ForEachLZMABlockConcurrently(this->blocks, [level = this->compression_level](LZMABlock &block) {
+			size_t out_pos = 0;
+			block.compressed.resize(lzma_stream_buffer_bound(block.data.size()));
+			block.ok = lzma_easy_buffer_encode(level, LZMA_CHECK_CRC32, nullptr, block.data.data(), block.data.size(), block.compressed.data(), &out_pos, block.compressed.size()) == LZMA_OK;
+			block.compressed.resize(out_pos);
+		});
+
+		for (LZMABlock &block : this->blocks) {
+			if (!block.ok) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "liblzma returned error code");
+
+			this->WriteBlockHeader(block.data.size(), block.compressed.size());
+			this->chain->Write(block.compressed.data(), block.compressed.size());
+		}
+		this->blocks.clear();
+	}
+
+	void Write(uint8_t *buf, size_t size) override
+	{
+		while (size > 0) {
+			if (this->blocks.empty() || this->blocks.back().data.size() == LZMA_BLOCK_SIZE) {
+				if (this->blocks.size() == GetConcurrentLZMABlocks()) this->CompressBlocks();
+				this->blocks.emplace_back().data.reserve(LZMA_BLOCK_SIZE);
+			}
+
+			std::vector<uint8_t> &data = this->blocks.back().data;
+			size_t to_copy = std::min(LZMA_BLOCK_SIZE - data.size(), size);
+			data.insert(data.end(), buf, buf + to_copy);
+			buf += to_copy;
+			size -= to_copy;
+		}
+	}
+
+	void Finish() override
+	{
+		this->CompressBlocks();
+		this->WriteBlockHeader(0, 0);
+		this->chain->Finish();
+	}
+};
+
 #endif /* WITH_LIBLZMA */
 
 /*******************************************
@@ -2701,6 +3204,7 @@ static const uint32_t SAVEGAME_TAG_LZO = TO_BE32X('OTTD');
 static const uint32_t SAVEGAME_TAG_NONE = TO_BE32X('OTTN');
 static const uint32_t SAVEGAME_TAG_ZLIB = TO_BE32X('OTTZ');
 static const uint32_t SAVEGAME_TAG_LZMA = TO_BE32X('OTTX');
+static const uint32_t SAVEGAME_TAG_LZMA_BLOCK = TO_BE32X('OTTB');
 
 /** The different saveload formats known/understood by OpenTTD. */
 static const SaveLoadFormat _saveload_formats[] = {
@@ -2720,6 +3224,13 @@ static const SaveLoadFormat _saveload_formats[] = {
 #else
 	{"zlib", SAVEGAME_TAG_ZLIB, nullptr,                            nullptr,                            0, 0, 0},
 #endif
+#if defined(WITH_LIBLZMA)
+	/* Slightly larger than plain LZMA at the same level, but (de)compression is spread over all cores.
+	 * It's listed before plain LZMA so it isn't the default format. */
+	{"lzmablock", SAVEGAME_TAG_LZMA_BLOCK, CreateLoadFilter<LZMABlockLoadFilter>, CreateSaveFilter<LZMABlockSaveFilter>, 0, 2, 9},
+#else
+	{"lzmablock", SAVEGAME_TAG_LZMA_BLOCK, nullptr,                         nullptr,                         0, 0, 0},
+#endif
 #if defined(WITH_LIBLZMA)
 	/* Level 2 compression is speed wise as fast as zlib level 6 compression (old default), but results in ~10% smaller saves.
 	 * Higher compression levels are possible, and might improve savegame size by up to 25%, but are also up to 10 times slower.
@@ -2802,6 +3313,13 @@ static inline void ClearSaveLoadState()
 	_sl.sf = nullptr;
 	_sl.reader = nullptr;
 	_sl.lf = nullptr;
+
+	_sl.hash_chunks = false;
+	_sl.delta_base.clear();
+	_sl.allow_delta = false;
+	_sl.chunk_hashes.clear();
+	_sl.base_data = {};
+	_sl.base_chunks.clear();
 }
 
 /** Update the gui accordingly when starting saving and set locks on saveload. */
@@ -2859,7 +3377,7 @@ static void SaveFileError()
 static SaveOrLoadResult SaveFileToDisk(bool threaded)
 {
 	try {
-		auto [fmt, compression] = GetSavegameFormat(_savegame_format);
+		auto [fmt, compression] = GetSavegameFormat(_sl.format);
 
 		/* We have written our stuff to memory, now write it to file! */
 		uint32_t hdr[2] = { fmt.tag, TO_BE32(SAVEGAME_VERSION << 16) };
@@ -2868,12 +3386,22 @@ static SaveOrLoadResult SaveFileToDisk(bool threaded)
 		_sl.sf = fmt.init_write(_sl.sf, compression);
 		_sl.dumper->Flush(_sl.sf);
 
+		/* Delta autosaves may only refer to a full autosave that has been written completely. */
+		if (_sl.hash_chunks) {
+			if (_sl.delta_base.empty()) {
+				_delta_save_base = {_sl.filename, std::move(_sl.chunk_hashes), 0};
+			} else {
+				_delta_save_base.deltas++;
+			}
+		}
+
 		ClearSaveLoadState();
 
 		if (threaded) SetAsyncSaveFinish(SaveFileDone);
 
 		return SL_OK;
 	} catch (...) {
+		if (_sl.hash_chunks && _sl.delta_base.empty()) _delta_save_base = {};
 		ClearSaveLoadState();
 
 		AsyncSaveFinishProc asfp = SaveFileDone;
@@ -2897,6 +3425,10 @@ static SaveOrLoadResult SaveFileToDisk(bool threaded)
 
 void WaitTillSaved()
 {
+#ifdef WITH_FORKED_SAVE
+	ReapSaveProcess(true);
+#endif
+
 	if (!_save_thread.joinable()) return;
 
 	_save_thread.join();
@@ -2905,24 +3437,149 @@ void WaitTillSaved()
 	ProcessAsyncSaveFinish();
 }
 
+#ifdef WITH_FORKED_SAVE
+/**
+ * Get the network sockets and epoll instances a forked savegame process would inherit.
+ * The child closes them, so connections the parent closes during the save are really
+ * closed. The open files are listed from /proc, so this does not depend on the limit
+ * of open files, which can be very high.
+ * @param[out] files The files to close in the child.
+ * @return True if the open files could be listed.
+ */
+static bool GetInheritedNetworkFiles(std::vector<int> &files)
+{
+	std::error_code error_code;
+	std::filesystem::directory_iterator it("/proc/self/fd", error_code);
+	if (error_code) return false;
+
+	for (const auto &entry : it) {
+		std::string name = entry.path().filename().string();
+		int fd;
+		auto [end, error] = std::from_chars(name.data(), name.data() + name.size(), fd);
+		if (error != std::errc{} || end != name.data() + name.size() || fd <= STDERR_FILENO) continue;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0) continue;
+
+		/* Epoll instances are anonymous inodes, which have no file type. */
+		if (S_ISSOCK(st.st_mode) || (st.st_mode & S_IFMT) == 0) files.push_back(fd);
+	}
+	return true;
+}
+
+/**
+ * Save the game from a forked process. The child gets a copy-on-write
+ * snapshot of the game state, so the game can continue while the whole
+ * savegame is being made. The child is reaped by ReapSaveProcess.
+ *
+ * Only the saving thread survives in the child, and it does not limit itself
+ * to async-signal-safe functions: making the savegame allocates memory,
+ * formats strings and may start compression threads. This relies on glibc,
+ * whose fork handlers reset the locks of the allocator and stdio in the child;
+ * that is why forked saves are only available with glibc. Locks of the game
+ * itself held by other threads of the parent, such as those of the link graph
+ * jobs, are never released in the child, but saving only reads the game state
+ * that belongs to the saving thread. Debug messages of the child are kept away
+ * from the remote console queue, which is guarded by such a lock.
+ * @return True if the child process is saving the game, false if forking failed.
+ */
+static bool DoForkedSave()
+{
+	extern std::atomic<bool> _debug_remote_console;
+
+	std::vector<int> network_files;
+	if (!GetInheritedNetworkFiles(network_files)) {
+		Debug(sl, 1, "Cannot list open files for savegame process, reverting to threaded mode...");
+		return false;
+	}
+
+	pid_t pid = fork();
+	if (pid < 0) {
+		Debug(sl, 1, "Cannot fork savegame process, reverting to threaded mode...");
+		return false;
+	}
+
+	if (pid == 0) {
+		for (int fd : network_files) close(fd);
+		_debug_remote_console.store(false);
+
+		/* Only this thread survives the fork, so everything happens here and
+		 * we leave without running any of the parent's cleanup. */
+		SaveOrLoadResult result = SL_ERROR;
+		try {
+			SlSaveChunks();
+			result = SaveFileToDisk(false);
+		} catch (...) {
+			/* Skip the "colour" character */
+			Debug(sl, 0, "{}", GetString(GetSaveLoadErrorType()).substr(3) + GetString(GetSaveLoadErrorMessage()));
+		}
+		_exit(result == SL_OK ? 0 : 1);
+	}
+
+	_save_process = pid;
+	SaveFileStart();
+
+	/* The child has its own copy of the file; close ours without writing anything. */
+	ClearSaveLoadState();
+	return true;
+}
+
+/**
+ * Check whether the forked savegame process has finished, and if so update
+ * the state as if a threaded save finished.
+ * @param wait Whether to wait for the process to finish.
+ */
+static void ReapSaveProcess(bool wait)
+{
+	if (_save_process < 0) return;
+
+	int status = 0;
+	pid_t pid;
+	do {
+		pid = waitpid(_save_process, &status, wait ? 0 : WNOHANG);
+	} while (pid < 0 && errno == EINTR);
+	if (pid == 0) return;
+
+	_save_process = -1;
+	if (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+		SaveFileDone();
+		return;
+	}
+
+	_sl.action = SLA_SAVE;
+	_sl.error_str = STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR;
+	_sl.extra_msg = "savegame process failed";
+	SaveFileError();
+}
+#endif /* WITH_FORKED_SAVE */
+
 /**
  * Actually perform the saving of the savegame.
  * General tactics is to first save the game to memory, then write it to file
  * using the writer, either in threaded mode if possible, or single-threaded.
+ * On dedicated servers the whole save may instead be done from a forked process.
  * @param writer   The filter to write the savegame to.
  * @param threaded Whether to try to perform the saving asynchronously.
+ * @param forked   Whether to try to perform the saving from a forked process.
  * @return Return the result of the action. #SL_OK or #SL_ERROR
  */
-static SaveOrLoadResult DoSave(std::shared_ptr<SaveFilter> writer, bool threaded)
+static SaveOrLoadResult DoSave(std::shared_ptr<SaveFilter> writer, bool threaded, [[maybe_unused]] bool forked = false)
 {
 	assert(!_sl.saveinprogress);
 
 	_sl.dumper = std::make_unique<MemoryDumper>();
 	_sl.sf = writer;
+	/* Autosaves are rarely loaded, so they may be compressed with less effort. */
+	_sl.format = _do_autosave && !_autosave_format.empty() ? _autosave_format : _savegame_format;
 
 	_sl_version = SAVEGAME_VERSION;
 
 	SaveViewportBeforeSaveGame();
+
+#ifdef WITH_FORKED_SAVE
+	if (forked && DoForkedSave()) return SL_OK;
+#endif
+
 	SlSaveChunks();
 
 	SaveFileStart();
@@ -2999,6 +3656,121 @@ static const SaveLoadFormat *DetermineSaveLoadFormat(uint32_t tag, uint32_t raw_
 	return fmt;
 }
 
+/** Reads a chunk of the base of a delta savegame from memory. */
+struct BaseChunkReader : LoadFilter {
+	std::span<const uint8_t> data; ///< The data of the chunk that has not been read yet.
+
+	/**
+	 * Create the reader for a chunk.
+	 * @param data The data of the chunk.
+	 */
+	BaseChunkReader(std::span<const uint8_t> data) : LoadFilter(nullptr), data(data)
+	{
+	}
+
+	size_t Read(uint8_t *buf, size_t size) override
+	{
+		size = std::min(size, this->data.size());
+		std::copy_n(this->data.data(), size, buf);
+		this->data = this->data.subspan(size);
+		return size;
+	}
+
+	void Reset() override
+	{
+		NOT_REACHED();
+	}
+};
+
+/**
+ * Read the base savegame of a delta savegame, and find where its chunks are.
+ * The delta savegame only refers to chunks of it, so the base is only read
+ * into memory, not loaded.
+ */
+static void SlReadDeltaBase()
+{
+	std::string filename(SlReadArrayLength(), '\0');
+	SlCopyBytes(filename.data(), filename.size());
+	Debug(sl, 1, "Reading base savegame '{}'", filename);
+
+	/* Savegames from elsewhere, like the network, may not make us read other files. */
+	if (!_sl.allow_delta) SlErrorCorrupt("Delta savegames can only be loaded from a file");
+	if (filename.find_first_of("/\\") != std::string::npos) SlErrorCorruptFmt("Invalid name '{}' of the base savegame", filename);
+
+	auto fh = FioFOpenFile(filename, "rb", AUTOSAVE_DIR);
+	if (!fh.has_value()) SlErrorCorruptFmt("Base savegame '{}' of this delta savegame is missing", filename);
+	std::shared_ptr<LoadFilter> lf = std::make_shared<FileReader>(std::move(*fh));
+
+	/* The chunks are read as if they are part of the delta savegame, so both must be of the same version. */
+	uint32_t hdr[2];
+	if (lf->Read((uint8_t*)hdr, sizeof(hdr)) != sizeof(hdr)) SlErrorCorruptFmt("Base savegame '{}' is not readable", filename);
+	auto fmt = std::ranges::find(_saveload_formats, hdr[0], &SaveLoadFormat::tag);
+	if (fmt == std::end(_saveload_formats) || fmt->init_load == nullptr || (TO_BE32(hdr[1]) >> 16) != _sl_version) {
+		SlErrorCorruptFmt("Base savegame '{}' is not of the same format as this delta savegame", filename);
+	}
+	lf = fmt->init_load(lf);
+
+	std::vector<uint8_t> &data = _sl.base_data;
+	data.clear();
+	for (size_t len = MEMORY_CHUNK_SIZE; len != 0;) {
+		size_t size = data.size();
+		data.resize(size + MEMORY_CHUNK_SIZE);
+		len = lf->Read(data.data() + size, MEMORY_CHUNK_SIZE);
+		data.resize(size + len);
+	}
+
+	/* Walk over the chunks, in the same way as they are skipped when they are not known. */
+	std::unique_ptr<ReadBuffer> reader = std::exchange(_sl.reader, std::make_unique<ReadBuffer>(std::make_shared<BaseChunkReader>(data)));
+	_sl.base_chunks.clear();
+	for (uint32_t id = SlReadUint32(); id != 0; id = SlReadUint32()) {
+		size_t begin = _sl.reader->GetSize();
+		uint8_t m = SlReadByte();
+		switch (m & CH_TYPE_MASK) {
+			case CH_RIFF: {
+				size_t len = (SlReadByte() << 16) | ((m >> 4) << 24);
+				len += SlReadUint16();
+				SlSkipBytes(len);
+				break;
+			}
+			case CH_ARRAY:
+			case CH_SPARSE_ARRAY:
+			case CH_TABLE:
+			case CH_SPARSE_TABLE:
+				for (size_t len = SlReadArrayLength(); len != 0; len = SlReadArrayLength()) SlSkipBytes(len - 1);
+				break;
+			default:
+				SlErrorCorruptFmt("Base savegame '{}' is not a full savegame", filename);
+		}
+		_sl.base_chunks[id] = {begin, _sl.reader->GetSize()};
+	}
+	_sl.reader = std::move(reader);
+}
+
+/**
+ * Load a chunk of a delta savegame that is the same as in its base savegame.
+ * @param ch The chunkhandler that will be used for the operation.
+ * @param load_check Whether to only load the chunk for checking the savegame.
+ */
+static void SlLoadBaseChunk(const ChunkHandler &ch, bool load_check)
+{
+	uint64_t hash = SlReadUint64();
+
+	auto it = _sl.base_chunks.find(ch.id);
+	if (it == _sl.base_chunks.end()) SlErrorCorruptFmt("Chunk {} is missing in the base savegame", ch.GetName());
+	std::span<const uint8_t> data(_sl.base_data.begin() + it->second.first, _sl.base_data.begin() + it->second.second);
+	if (HashChunkData(CHUNK_HASH_OFFSET_BASIS, data) != hash) SlErrorCorruptFmt("Chunk {} of the base savegame has changed", ch.GetName());
+
+	Debug(sl, 2, "Loading chunk {} from the base savegame", ch.GetName());
+	std::unique_ptr<ReadBuffer> reader = std::exchange(_sl.reader, std::make_unique<ReadBuffer>(std::make_shared<BaseChunkReader>(data)));
+	if (load_check) {
+		SlLoadCheckChunk(ch);
+	} else {
+		SlLoadChunk(ch);
+	}
+	if (_sl.reader->GetSize() != data.size()) SlErrorCorruptFmt("Invalid chunk size of chunk {} in the base savegame", ch.GetName());
+	_sl.reader = std::move(reader);
+}
+
 /**
  * Actually perform the loading of a "non-old" savegame.
  * @param reader     The filter to read the savegame from.
@@ -3116,6 +3888,64 @@ SaveOrLoadResult LoadWithFilter(std::shared_ptr<LoadFilter> reader)
 	}
 }
 
+/**
+ * Decompress a savegame without loading it, so it can be decompressed while it is
+ * still being received. The decompressed savegame is written in the uncompressed
+ * savegame format, and can be loaded like any other savegame. This does not touch
+ * the global saveload state, so it may be called from any thread.
+ * @param reader The filter to read the compressed savegame from.
+ * @param writer The filter to write the decompressed savegame to.
+ * @return True iff the savegame was decompressed; false if it is not compressed,
+ *         of an unknown format or too new, or broken.
+ */
+bool DecompressSavegame(std::shared_ptr<LoadFilter> reader, SaveFilter &writer)
+{
+	AutoRestoreBackup decompress_ahead(_sl_decompress_ahead, true);
+
+	try {
+		uint32_t hdr[2];
+		if (reader->Read((uint8_t*)hdr, sizeof(hdr)) != sizeof(hdr)) return false;
+
+		/* Unknown and buggy savegames are left to the loader to make sense of. */
+		auto fmt = std::ranges::find(_saveload_formats, hdr[0], &SaveLoadFormat::tag);
+		if (fmt == std::end(_saveload_formats) || fmt->init_load == nullptr || fmt->tag == SAVEGAME_TAG_NONE) return false;
+		if ((SaveLoadVersion)(TO_BE32(hdr[1]) >> 16) > SAVEGAME_VERSION) return false;
+
+		hdr[0] = SAVEGAME_TAG_NONE;
+		writer.Write((uint8_t*)hdr, sizeof(hdr));
+
+		std::shared_ptr<LoadFilter> lf = fmt->init_load(reader);
+		uint8_t buf[MEMORY_CHUNK_SIZE];
+		for (size_t len; (len = lf->Read(buf, sizeof(buf))) != 0;) writer.Write(buf, len);
+		writer.Finish();
+		return true;
+	} catch (...) {
+		return false;
+	}
+}
+
+/**
+ * Decide whether the autosave that is about to be written is a delta autosave.
+ * After each full autosave up to #_autosave_deltas delta autosaves are written,
+ * in which the chunks that did not change since are only a reference to the
+ * chunk in the full autosave.
+ * @param filename The name of the autosave in the autosave directory.
+ */
+static void PrepareDeltaAutosave(const std::string &filename)
+{
+	_sl.hash_chunks = _do_autosave && _autosave_deltas != 0;
+	if (!_sl.hash_chunks) return;
+
+	_sl.filename = filename;
+	_sl.chunk_hashes.clear();
+
+	/* Never overwrite the full autosave with a delta autosave that refers to it. */
+	const DeltaSaveBase &base = _delta_save_base;
+	bool delta = !base.filename.empty() && base.deltas < _autosave_deltas && filename != base.filename;
+	_sl.delta_base = delta ? base.filename : std::string{};
+	Debug(sl, 2, "Writing {} autosave", delta ? "delta" : "full");
+}
+
 /**
  * Main Save or Load function where the high-level saveload functions are
  * handled. It opens the savegame, selects format and checks versions
@@ -3191,13 +4021,17 @@ SaveOrLoadResult SaveOrLoad(const std::string &filename, SaveLoadOperation fop,
 		if (fop == SLO_SAVE) { // SAVE game
 			Debug(desync, 1, "save: {:08x}; {:02x}; {}", TimerGameEconomy::date, TimerGameEconomy::date_fract, filename);
 			if (!_settings_client.gui.threaded_saves) threaded = false;
+			if (sb == AUTOSAVE_DIR) PrepareDeltaAutosave(filename);
+			/* Only the forked process would know the hashes of the chunks of the autosave. */
+			bool forked = threaded && _network_dedicated && _settings_client.gui.forked_saves && !_sl.hash_chunks;
 
-			return DoSave(std::make_shared<FileWriter>(std::move(*fh)), threaded);
+			return DoSave(std::make_shared<FileWriter>(std::move(*fh)), threaded, forked);
 		}
 
 		/* LOAD game */
 		assert(fop == SLO_LOAD || fop == SLO_CHECK);
 		Debug(desync, 1, "load: {}", filename);
+		_sl.allow_delta = true;
 		return DoLoad(std::make_shared<FileReader>(std::move(*fh)), fop == SLO_CHECK);
 	} catch (...) {
 		/* This code may be executed both for old and new save games. */
@@ -395,6 +395,9 @@ enum SaveLoadVersion : uint16_t {
 	SLV_PATH_CACHE_FORMAT,                  ///< 346  PR#12345 Vehicle path cache format changed.
 	SLV_ANIMATED_TILE_STATE_IN_MAP,         ///< 347  PR#13082 Animated tile state saved for improved performance.
 	SLV_INCREASE_HOUSE_LIMIT,               ///< 348  PR#12288 Increase house limit to 4096.
+	SLV_CARGO_MERGE_AGE_TOLERANCE,          ///< 349  Merging of waiting cargo packets of similar age.
+	SLV_LINKGRAPH_MEMORY_BUDGET,            ///< 350  Memory budget for concurrently running link graph jobs.
+	SLV_LINKGRAPH_DEMAND_MODE,              ///< 351  Selectable demand calculation for link graph jobs.
 
 	SL_MAX_VERSION,                         ///< Highest possible saveload version
 };
@@ -444,6 +447,7 @@ void DoAutoOrNetsave(FiosNumberedSaveName &counter);
 
 SaveOrLoadResult SaveWithFilter(std::shared_ptr<struct SaveFilter> writer, bool threaded);
 SaveOrLoadResult LoadWithFilter(std::shared_ptr<struct LoadFilter> reader);
+bool DecompressSavegame(std::shared_ptr<struct LoadFilter> reader, struct SaveFilter &writer);
 
 typedef void AutolengthProc(int);
 
@@ -474,6 +478,21 @@ struct ChunkHandler {
 	 */
 	virtual void Save() const { NOT_REACHED(); }
 
+	/**
+	 * Whether the chunk is saved with SaveToBuffer instead of Save.
+	 * Only possible for CH_RIFF chunks.
+	 * @return True iff SaveToBuffer is implemented.
+	 */
+	virtual bool CanSaveToBuffer() const { return false; }
+
+	/**
+	 * Save the data of the chunk to a buffer. This is done on another thread
+	 * while the other chunks are being saved, so it may only read the game
+	 * state and may not use any of the saveload functions.
+	 * @param[in,out] buffer Buffer to append the data to.
+	 */
+	virtual void SaveToBuffer([[maybe_unused]] std::vector<uint8_t> &buffer) const { NOT_REACHED(); }
+
 	/**
 	 * Load the chunk.
 	 * Must be overridden.
@@ -1348,6 +1367,8 @@ inline void SlSkipBytes(size_t length)
 }
 
 extern std::string _savegame_format;
+extern std::string _autosave_format;
+extern uint8_t _autosave_deltas;
 extern bool _do_autosave;
 
 /**
@@ -167,6 +167,7 @@ struct GUISettings {
 	ZoomLevel sprite_zoom_min;               ///< maximum zoom level at which higher-resolution alternative sprites will be used (if available) instead of scaling a lower resolution sprite
 	uint32_t autosave_interval;              ///< how often should we do autosaves?
 	bool   threaded_saves;                   ///< should we do threaded saves?
+	bool   forked_saves;                     ///< should dedicated servers save from a forked process?
 	bool   keep_all_autosave;                ///< name the autosave in a different way
 	bool   autosave_on_exit;                 ///< save an autosave when you quit the game, but do not ask "Do you really want to quit?"
 	bool   autosave_on_network_disconnect;   ///< save an autosave when you get disconnected from a network game with an error?
@@ -549,7 +550,9 @@ struct LinkGraphSettings {
 	uint8_t accuracy;                         ///< accuracy when calculating things on the link graph. low accuracy => low running time
 	uint8_t demand_size;                      ///< influence of supply ("station size") on the demand function
 	uint8_t demand_distance;                  ///< influence of distance between stations on the demand function
+	DemandMode demand_mode;                 ///< way of calculating demands between the nodes
 	uint8_t short_path_saturation;            ///< percentage up to which short paths are saturated before saturating most capacious paths
+	uint16_t max_job_memory;                  ///< estimated memory in MiB all running link graph jobs may use together, 0 for no limit
 
 	inline DistributionType GetDistributionType(CargoID cargo) const
 	{
@@ -565,6 +568,7 @@ struct StationSettings {
 	bool   modified_catchment;               ///< different-size catchment areas
 	bool   serve_neutral_industries;         ///< company stations can serve industries with attached neutral stations
 	bool   distant_join_stations;            ///< allow to join non-adjacent stations
+	uint8_t cargo_merge_age_tolerance;       ///< maximum difference in cargo aging periods for merging waiting cargo packets
 	bool   never_expire_airports;            ///< never expire airports
 	uint8_t station_spread;                  ///< amount a station may spread
 };
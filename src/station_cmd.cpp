@@ -3791,8 +3791,11 @@ static bool StationHandleBigTick(BaseStation *st)
 	if (Station::IsExpected(st)) {
 		TriggerWatchedCargoCallbacks(Station::From(st));
 
+		uint16_t age_tolerance = _settings_game.station.cargo_merge_age_tolerance;
 		for (GoodsEntry &ge : Station::From(st)->goods) {
 			ClrBit(ge.status, GoodsEntry::GES_ACCEPTED_BIGTICK);
+			/* Packets only become mergeable with a tolerance; exact matches were merged on arrival. */
+			if (age_tolerance > 0 && ge.HasData()) ge.GetData().cargo.Compact(age_tolerance);
 		}
 	}
 
@@ -0,0 +1,42 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file mock_network.h Helpers to pass packets around without a network connection. */
+
+#ifndef MOCK_NETWORK_H
+#define MOCK_NETWORK_H
+
+#include "../network/core/packet.h"
+
+/**
+ * Send a packet and receive it again, as if it went over the network.
+ * @param source The packet to send.
+ * @param socket_handler The socket handler that receives the packet.
+ * @param limit The maximum size of the received packet.
+ * @return The received packet, positioned after its type, and whether it was valid.
+ */
+inline std::tuple<Packet, bool> CreatePacketForReading(Packet &source, NetworkSocketHandler *socket_handler, size_t limit)
+{
+	source.PrepareToSend();
+
+	Packet dest(socket_handler, limit, source.Size());
+
+	auto transfer_in = [](Packet &source, char *dest_data, size_t length) {
+		auto transfer_out = [](char *dest_data, const char *source_data, size_t length) {
+			std::copy(source_data, source_data + length, dest_data);
+			return length;
+		};
+		return source.TransferOutWithLimit(transfer_out, length, dest_data);
+	};
+	dest.TransferIn(transfer_in, source);
+
+	bool valid = dest.PrepareToRead();
+	dest.Recv_uint8(); // Ignore the type
+	return { dest, valid };
+}
+
+#endif /* MOCK_NETWORK_H */
@@ -0,0 +1,75 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file test_network_commands.cpp Tests for sending batches of commands over the network. */
+
+#include "../stdafx.h"
+
+#include "../3rdparty/catch2/catch.hpp"
+
+#include "../network/network_internal.h"
+#include "../rail_cmd.h"
+#include "mock_network.h"
+
+class MockNetworkGameSocketHandler : public NetworkGameSocketHandler {
+public:
+	MockNetworkGameSocketHandler() : NetworkGameSocketHandler(INVALID_SOCKET) {}
+	NetworkRecvStatus CloseConnection(NetworkRecvStatus status) override { return status; }
+};
+
+TEST_CASE("Command batch loopback")
+{
+	MockNetworkGameSocketHandler handler;
+
+	/* Something like an AI building a long stretch of rail. */
+	std::vector<CommandPacket> commands(100);
+	for (uint i = 0; i < commands.size(); i++) {
+		CommandPacket &cp = commands[i];
+		cp.company = COMPANY_FIRST;
+		cp.frame = 1234 + i / 50;
+		cp.my_cmd = false;
+		cp.cmd = CMD_BUILD_SINGLE_RAIL;
+		cp.err_msg = 0;
+		cp.callback = nullptr;
+		cp.data = EndianBufferWriter<CommandDataBuffer>::FromValue(CommandTraits<CMD_BUILD_SINGLE_RAIL>::Args{ TileIndex{1000 + i}, RAILTYPE_RAIL, TRACK_X, false });
+	}
+
+	size_t single_size = 0;
+	for (const CommandPacket &cp : commands) {
+		Packet p(&handler, PACKET_SERVER_COMMAND);
+		handler.SendCommand(p, cp);
+		p.Send_uint32(cp.frame);
+		p.Send_bool(cp.my_cmd);
+		p.PrepareToSend();
+		single_size += p.Size();
+	}
+
+	Packet batch(&handler, PACKET_SERVER_COMMANDS, TCP_MTU);
+	const CommandPacket *prev = nullptr;
+	for (const CommandPacket &cp : commands) {
+		CHECK(handler.SendCommandInBatch(batch, cp, prev));
+		prev = &cp;
+	}
+
+	auto [read, valid] = CreatePacketForReading(batch, &handler, TCP_MTU);
+	CHECK(valid);
+	CHECK(read.Size() * 2 < single_size);
+
+	CommandPacket cp;
+	for (const CommandPacket &expected : commands) {
+		CHECK(read.CanReadFromPacket(sizeof(uint8_t)));
+		CHECK(handler.ReceiveCommandInBatch(read, cp, &expected == &commands.front()) == nullptr);
+		CHECK(cp.company == expected.company);
+		CHECK(cp.frame == expected.frame);
+		CHECK(cp.my_cmd == expected.my_cmd);
+		CHECK(cp.cmd == expected.cmd);
+		CHECK(cp.err_msg == expected.err_msg);
+		CHECK(cp.callback == expected.callback);
+		CHECK(cp.data == expected.data);
+	}
+	CHECK_FALSE(read.CanReadFromPacket(sizeof(uint8_t)));
+}
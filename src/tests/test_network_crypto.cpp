@@ -15,6 +15,7 @@
 #include "../network/network_crypto_internal.h"
 #include "../network/core/packet.h"
 #include "../string_func.h"
+#include "mock_network.h"
 
 /* The length of the hexadecimal representation of a X25519 key must fit in the key length. */
 static_assert(NETWORK_SECRET_KEY_LENGTH >= X25519_KEY_SIZE * 2 + 1);
@@ -31,26 +32,6 @@ public:
 
 static MockNetworkSocketHandler mock_socket_handler;
 
-static std::tuple<Packet, bool> CreatePacketForReading(Packet &source, MockNetworkSocketHandler *socket_handler)
-{
-	source.PrepareToSend();
-
-	Packet dest(socket_handler, COMPAT_MTU, source.Size());
-
-	auto transfer_in = [](Packet &source, char *dest_data, size_t length) {
-		auto transfer_out = [](char *dest_data, const char *source_data, size_t length) {
-			std::copy(source_data, source_data + length, dest_data);
-			return length;
-		};
-		return source.TransferOutWithLimit(transfer_out, length, dest_data);
-	};
-	dest.TransferIn(transfer_in, source);
-
-	bool valid = dest.PrepareToRead();
-	dest.Recv_uint8(); // Ignore the type
-	return { dest, valid };
-}
-
 class TestPasswordRequestHandler : public NetworkAuthenticationPasswordRequestHandler {
 private:
 	std::string password;
@@ -68,14 +49,14 @@ static void TestAuthentication(NetworkAuthenticationServerHandler &server, Netwo
 	server.SendRequest(request);
 
 	bool valid;
-	std::tie(request, valid) = CreatePacketForReading(request, &mock_socket_handler);
+	std::tie(request, valid) = CreatePacketForReading(request, &mock_socket_handler, COMPAT_MTU);
 	CHECK(valid);
 	CHECK(client.ReceiveRequest(request) == expected_request_result);
 
 	Packet response(&mock_socket_handler, PacketType{});
 	client.SendResponse(response);
 
-	std::tie(response, valid) = CreatePacketForReading(response, &mock_socket_handler);
+	std::tie(response, valid) = CreatePacketForReading(response, &mock_socket_handler, COMPAT_MTU);
 	CHECK(valid);
 	CHECK(server.ReceiveResponse(response) == expected_response_result);
 }
@@ -222,7 +203,7 @@ static void CheckEncryption(MockNetworkSocketHandler *sending_socket_handler, Mo
 		Packet request(sending_socket_handler, sent_packet_type);
 		request.Send_uint64(sent_value);
 
-		auto [response, valid] = CreatePacketForReading(request, receiving_socket_handler);
+		auto [response, valid] = CreatePacketForReading(request, receiving_socket_handler, COMPAT_MTU);
 		CHECK(valid);
 		CHECK(response.Recv_uint64() == sent_value);
 
@@ -254,7 +235,7 @@ TEST_CASE("Encryption handling")
 	server.SendEnableEncryption(packet);
 
 	bool valid;
-	std::tie(packet, valid) = CreatePacketForReading(packet, &mock_socket_handler);
+	std::tie(packet, valid) = CreatePacketForReading(packet, &mock_socket_handler, COMPAT_MTU);
 	CHECK(valid);
 	CHECK(client.ReceiveEnableEncryption(packet));
 
@@ -273,7 +254,58 @@ TEST_CASE("Encryption handling")
 		Packet request(&mock_socket_handler, PacketType{});
 		request.Send_uint64(0);
 
-		auto [response, valid] = CreatePacketForReading(request, &client_socket_handler);
+		auto [response, valid] = CreatePacketForReading(request, &client_socket_handler, COMPAT_MTU);
 		CHECK(!valid);
 	}
+
+	SECTION("Encryption of a stream of packets") {
+		/* Something like a map transfer, interleaved with small game packets. */
+		for (int i = 0; i < 64; i++) {
+			Packet request(&server_socket_handler, PacketType{}, TCP_MTU);
+			uint8_t value = 0;
+			while (request.CanWriteToPacket(sizeof(uint8_t))) request.Send_uint8(value++);
+
+			auto [response, valid] = CreatePacketForReading(request, &client_socket_handler, TCP_MTU);
+			CHECK(valid);
+			value = 0;
+			bool equal = true;
+			while (response.CanReadFromPacket(sizeof(uint8_t))) equal &= response.Recv_uint8() == value++;
+			CHECK(equal);
+
+			Packet frame(&server_socket_handler, PacketType{});
+			frame.Send_uint32(i);
+			std::tie(response, valid) = CreatePacketForReading(frame, &client_socket_handler, TCP_MTU);
+			CHECK(valid);
+			CHECK(response.Recv_uint32() == static_cast<uint32_t>(i));
+		}
+	}
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+	BENCHMARK("Encrypt and decrypt a full packet") {
+		Packet request(&server_socket_handler, PacketType{}, TCP_MTU);
+		while (request.CanWriteToPacket(sizeof(uint64_t))) request.Send_uint64(0);
+		return std::get<1>(CreatePacketForReading(request, &client_socket_handler, TCP_MTU));
+	};
+
+	BENCHMARK("Encrypt and decrypt a small packet") {
+		Packet request(&server_socket_handler, PacketType{});
+		request.Send_uint64(0);
+		return std::get<1>(CreatePacketForReading(request, &client_socket_handler, TCP_MTU));
+	};
+
+	/* What batching the small packets queued for a socket into one frame would save. */
+	auto handler = server.CreateServerToClientEncryptionHandler();
+	std::vector<uint8_t> mac(handler->MACSize());
+	std::vector<uint8_t> messages(64 * sizeof(uint64_t));
+
+	BENCHMARK("Encrypt 64 small packets one by one") {
+		for (size_t i = 0; i < messages.size(); i += sizeof(uint64_t)) handler->Encrypt(mac, std::span(messages).subspan(i, sizeof(uint64_t)));
+		return mac[0];
+	};
+
+	BENCHMARK("Encrypt 64 small packets as one frame") {
+		handler->Encrypt(mac, messages);
+		return mac[0];
+	};
+#endif /* CATCH_CONFIG_ENABLE_BENCHMARKING */
 }
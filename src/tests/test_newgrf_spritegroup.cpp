@@ -0,0 +1,255 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file test_newgrf_spritegroup.cpp Tests for resolving optimised and cached deterministic sprite groups. */
+
+#include "../stdafx.h"
+
+#include "../3rdparty/catch2/catch.hpp"
+
+#include "../newgrf_spritegroup.h"
+
+#include <random>
+
+/**
+ * Create a random deterministic sprite group that only uses variables which are
+ * available without any object to resolve for.
+ * @param random The random generator; a copy of the same generator gives the same group.
+ * @param results The groups to pick the results of the ranges from.
+ * @return The new group.
+ */
+static DeterministicSpriteGroup *CreateRandomGroup(std::mt19937 random, const std::vector<const SpriteGroup *> &results)
+{
+	/* Constant, callback, callback parameter 1 and 2. */
+	static const uint8_t variables[] = { 0x1A, 0x1A, 0x0C, 0x10, 0x18 };
+	/* Signed division can trap on the most negative value divided by -1, in the game as well. */
+	static const DeterministicSpriteGroupAdjustOperation operations[] = {
+		DSGA_OP_ADD, DSGA_OP_SUB, DSGA_OP_SMIN, DSGA_OP_SMAX, DSGA_OP_UMIN, DSGA_OP_UMAX, DSGA_OP_UDIV, DSGA_OP_UMOD,
+		DSGA_OP_MUL, DSGA_OP_AND, DSGA_OP_OR, DSGA_OP_XOR, DSGA_OP_STO, DSGA_OP_RST, DSGA_OP_STOP, DSGA_OP_ROR,
+		DSGA_OP_SCMP, DSGA_OP_UCMP, DSGA_OP_SHL, DSGA_OP_SHR, DSGA_OP_SAR,
+	};
+	static const uint32_t masks[] = { 0x0F, 0xFF, 0x1FF, 0xFFFF, 0xFFFFFFFF };
+
+	REQUIRE(DeterministicSpriteGroup::CanAllocateItem());
+	DeterministicSpriteGroup *group = new DeterministicSpriteGroup();
+	group->var_scope = VSG_SCOPE_SELF;
+	group->size = static_cast<DeterministicSpriteGroupSize>(random() % 3);
+
+	uint num_adjusts = 1 + random() % 5;
+	for (uint i = 0; i < num_adjusts; i++) {
+		DeterministicSpriteGroupAdjust &adjust = group->adjusts.emplace_back();
+		adjust.operation = i == 0 ? DSGA_OP_ADD : operations[random() % std::size(operations)];
+		adjust.variable = variables[random() % std::size(variables)];
+		adjust.parameter = 0;
+		adjust.shift_num = random() % 3 == 0 ? random() % 32 : 0;
+		adjust.type = static_cast<DeterministicSpriteGroupAdjustType>(random() % 3);
+		adjust.and_mask = masks[random() % std::size(masks)];
+		adjust.add_val = adjust.type == DSGA_TYPE_NONE ? 0 : random() % 256;
+		adjust.divmod_val = adjust.type == DSGA_TYPE_NONE ? 0 : 1 + random() % 255;
+		adjust.subroutine = nullptr;
+	}
+
+	group->default_group = results[random() % results.size()];
+	group->calculated_result = random() % 8 == 0;
+
+	/* Sorted ranges that do not overlap, like after loading them. */
+	if (!group->calculated_result) {
+		uint32_t low = random() % 64;
+		uint num_ranges = 1 + random() % 12;
+		for (uint i = 0; i < num_ranges; i++) {
+			DeterministicSpriteGroupRange &range = group->ranges.emplace_back();
+			range.group = results[random() % results.size()];
+			range.low = low;
+			range.high = low + random() % (random() % 4 == 0 ? 1000 : 20);
+			low = range.high + 1 + random() % 10;
+		}
+	}
+	group->error_group = group->ranges.empty() ? group->default_group : group->ranges[0].group;
+
+	return group;
+}
+
+TEST_CASE("Optimised deterministic sprite groups resolve like the original")
+{
+	std::vector<const SpriteGroup *> results;
+	REQUIRE(CallbackResultSpriteGroup::CanAllocateItem(8));
+	for (uint16_t i = 0; i < 8; i++) results.push_back(new CallbackResultSpriteGroup(i));
+	results.push_back(nullptr);
+
+	std::mt19937 random(1234);
+	for (uint i = 0; i < 500; i++) {
+		const DeterministicSpriteGroup *original = CreateRandomGroup(random, results);
+		DeterministicSpriteGroup *optimised = CreateRandomGroup(random, results);
+		optimised->Optimise();
+		random.discard(1000);
+
+		for (uint32_t param1 = 0; param1 < 1200; param1 += 1 + param1 / 64) {
+			uint32_t param2 = random();
+			auto resolve = [&](const SpriteGroup *group) {
+				ResolverObject object(nullptr, CBID_NO_CALLBACK, param1, param2);
+				const SpriteGroup *result = SpriteGroup::Resolve(group, object);
+				return std::make_pair(result, result == nullptr ? static_cast<uint16_t>(CALLBACK_FAILED) : result->GetCallbackResult());
+			};
+			CHECK(resolve(original) == resolve(optimised));
+
+			/* The second time the result of a group that is worth caching comes from the cache. */
+			for (uint j = 0; j < 2; j++) {
+				ResolverObject object(nullptr, CBID_NO_CALLBACK, param1, param2);
+				object.root_spritegroup = optimised;
+				CHECK(object.ResolveCallback() == resolve(original).second);
+			}
+		}
+	}
+
+	ClearCallbackCache();
+	_spritegroup_pool.CleanPool();
+}
+
+TEST_CASE("Constants are folded into the adjustment before them")
+{
+	REQUIRE(DeterministicSpriteGroup::CanAllocateItem());
+	DeterministicSpriteGroup *group = new DeterministicSpriteGroup();
+	group->var_scope = VSG_SCOPE_SELF;
+	group->size = DSG_SIZE_WORD;
+
+	/* (param1 & 0xFFFF & 0xFF) + 5 - 2 */
+	auto add_adjust = [&](DeterministicSpriteGroupAdjustOperation operation, uint8_t variable, uint32_t and_mask) {
+		DeterministicSpriteGroupAdjust &adjust = group->adjusts.emplace_back();
+		adjust = {};
+		adjust.operation = operation;
+		adjust.variable = variable;
+		adjust.and_mask = and_mask;
+	};
+	add_adjust(DSGA_OP_ADD, 0x10, 0xFFFF);
+	add_adjust(DSGA_OP_AND, 0x1A, 0xFF);
+	add_adjust(DSGA_OP_ADD, 0x1A, 5);
+	add_adjust(DSGA_OP_SUB, 0x1A, 2);
+
+	group->calculated_result = true;
+	group->default_group = nullptr;
+	group->error_group = nullptr;
+	group->Optimise();
+
+	REQUIRE(group->adjusts.size() == 2);
+	CHECK(group->adjusts[0].variable == 0x10);
+	CHECK(group->adjusts[0].and_mask == 0xFF);
+	CHECK(group->adjusts[1].variable == 0x1A);
+	CHECK(group->adjusts[1].operation == DSGA_OP_ADD);
+	CHECK(group->adjusts[1].and_mask == 3);
+
+	ResolverObject object(nullptr, CBID_NO_CALLBACK, 0x1234, 0);
+	object.root_spritegroup = group;
+	CHECK(object.ResolveCallback() == 0x34 + 3);
+
+	ClearCallbackCache();
+	_spritegroup_pool.CleanPool();
+}
+
+TEST_CASE("Only groups that do not depend on the game state are cacheable")
+{
+	auto create_group = [](uint8_t variable, DeterministicSpriteGroupAdjustOperation operation) {
+		REQUIRE(DeterministicSpriteGroup::CanAllocateItem());
+		DeterministicSpriteGroup *group = new DeterministicSpriteGroup();
+		group->var_scope = VSG_SCOPE_SELF;
+		group->size = DSG_SIZE_WORD;
+
+		DeterministicSpriteGroupAdjust &first = group->adjusts.emplace_back();
+		first = {};
+		first.operation = DSGA_OP_ADD;
+		first.variable = 0x10;
+		first.and_mask = 0xFFFF;
+
+		DeterministicSpriteGroupAdjust &second = group->adjusts.emplace_back();
+		second = {};
+		second.operation = operation;
+		second.variable = variable;
+		second.and_mask = 0xFF;
+
+		group->calculated_result = true;
+		group->default_group = nullptr;
+		group->error_group = nullptr;
+		group->Optimise();
+		return group;
+	};
+
+	CHECK(create_group(0x18, DSGA_OP_ADD)->cacheable);
+	CHECK_FALSE(create_group(0x18, DSGA_OP_ADD)->cache_results); // Cheaper to resolve than to look up
+	CHECK(create_group(0x7F, DSGA_OP_XOR)->cacheable);
+	CHECK_FALSE(create_group(0x18, DSGA_OP_STO)->cacheable);
+	CHECK_FALSE(create_group(0x00, DSGA_OP_ADD)->cacheable); // Date
+	CHECK_FALSE(create_group(0x5F, DSGA_OP_ADD)->cacheable); // Random bits
+	CHECK_FALSE(create_group(0x7D, DSGA_OP_ADD)->cacheable); // Temporary storage
+	CHECK_FALSE(create_group(0x40, DSGA_OP_ADD)->cacheable); // Object variable
+
+	ClearCallbackCache();
+	_spritegroup_pool.CleanPool();
+}
+
+TEST_CASE("Callback branches of a group that is not cacheable are cached")
+{
+	/* Sprite groups of a vehicle: graphics by default, and the callback computed from its parameter. */
+	REQUIRE(SpriteGroup::CanAllocateItem(4));
+
+	RealSpriteGroup *graphics = new RealSpriteGroup();
+	graphics->loaded.push_back(new ResultSpriteGroup(1234, 1));
+
+	DeterministicSpriteGroup *callback = new DeterministicSpriteGroup();
+	callback->var_scope = VSG_SCOPE_SELF;
+	callback->size = DSG_SIZE_WORD;
+	/* Parameter 1 plus four times parameter 2, which is 0; enough work to be worth caching. */
+	for (uint i = 0; i < 5; i++) {
+		DeterministicSpriteGroupAdjust &param = callback->adjusts.emplace_back();
+		param = {};
+		param.operation = DSGA_OP_ADD;
+		param.variable = i == 0 ? 0x10 : 0x18;
+		param.and_mask = 0xFF;
+	}
+	callback->calculated_result = true;
+	callback->default_group = nullptr;
+	callback->error_group = nullptr;
+	callback->Optimise();
+
+	DeterministicSpriteGroup *root = new DeterministicSpriteGroup();
+	root->var_scope = VSG_SCOPE_SELF;
+	root->size = DSG_SIZE_BYTE;
+	DeterministicSpriteGroupAdjust &cb = root->adjusts.emplace_back();
+	cb = {};
+	cb.operation = DSGA_OP_ADD;
+	cb.variable = 0x0C;
+	cb.and_mask = 0xFF;
+	root->calculated_result = false;
+	root->ranges.push_back({ callback, CBID_VEHICLE_LENGTH, CBID_VEHICLE_LENGTH });
+	root->default_group = graphics;
+	root->error_group = callback;
+	root->Optimise();
+
+	CHECK_FALSE(root->cacheable);
+	CHECK(callback->cache_results);
+
+	auto resolve_callback = [&](uint32_t param1) {
+		ResolverObject object(nullptr, CBID_VEHICLE_LENGTH, param1, 0);
+		object.root_spritegroup = root;
+		return object.ResolveCallback();
+	};
+
+	CHECK(resolve_callback(3) == 3);
+	CHECK(resolve_callback(4) == 4);
+
+	/* Change the callback branch behind the back of the cache, to see which results come from it. */
+	callback->adjusts[0].and_mask = 0;
+	CHECK(resolve_callback(3) == 3);
+	CHECK(resolve_callback(4) == 4);
+	CHECK(resolve_callback(5) == 0);
+
+	/* Graphics are still resolved through the real sprite group. */
+	ResolverObject object(nullptr, CBID_NO_CALLBACK, 3, 0);
+	object.root_spritegroup = root;
+	CHECK(object.Resolve() == graphics->loaded[0]);
+
+	ClearCallbackCache();
+	_spritegroup_pool.CleanPool();
+}